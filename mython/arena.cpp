@@ -0,0 +1,63 @@
+#include "arena.h"
+
+using namespace std;
+
+namespace runtime {
+
+namespace {
+
+// арена, активная в текущем потоке
+thread_local Arena* active_arena = nullptr;
+
+}  // namespace
+
+void* Arena::Allocate(size_t size, size_t alignment) {
+    if (!blocks_.empty()) {
+        Block& block = blocks_.back();
+        size_t aligned = (block.used + alignment - 1) & ~(alignment - 1);
+        if (aligned + size <= block.size) {
+            block.used = aligned + size;
+            return block.data.get() + aligned;
+        }
+    }
+    Block& block = AddBlock(size + alignment);
+    size_t address = reinterpret_cast<size_t>(block.data.get());
+    size_t aligned = ((address + alignment - 1) & ~(alignment - 1)) - address;
+    block.used = aligned + size;
+    return block.data.get() + aligned;
+}
+
+size_t Arena::BytesReserved() const {
+    size_t total = 0;
+    for (const Block& block : blocks_) {
+        total += block.size;
+    }
+    return total;
+}
+
+Arena::Block& Arena::AddBlock(size_t min_size) {
+    size_t block_size = DEFAULT_BLOCK_SIZE;
+    while (block_size < min_size) {
+        block_size *= 2;
+    }
+    Block block;
+    block.data = make_unique<unsigned char[]>(block_size);
+    block.size = block_size;
+    blocks_.push_back(std::move(block));
+    return blocks_.back();
+}
+
+Arena::Scope::Scope(Arena& arena) {
+    previous_ = active_arena;
+    active_arena = &arena;
+}
+
+Arena::Scope::~Scope() {
+    active_arena = previous_;
+}
+
+Arena* Arena::Active() {
+    return active_arena;
+}
+
+}  // namespace runtime
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace runtime {
+
+// Блочный (bump) аллокатор для узлов AST. Узлы одной программы
+// размещаются в блоках арены подряд, в порядке создания, и освобождаются
+// одним махом вместе с ареной. Арена должна жить дольше, чем построенное
+// в ней дерево программы
+class Arena {
+public:
+    // размер блока по умолчанию
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+    Arena() = default;
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    // Выделяет size байт с выравниванием alignment
+    void* Allocate(size_t size, size_t alignment);
+
+    // Возвращает суммарный объём памяти, выделенной блоками арены
+    [[nodiscard]] size_t BytesReserved() const;
+
+    // RAII-активация арены в текущем потоке: пока Scope жив,
+    // operator new узлов AST берёт память из арены
+    class Scope {
+    public:
+        explicit Scope(Arena& arena);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        Arena* previous_;
+    };
+
+    // Возвращает арену, активную в текущем потоке, либо nullptr
+    static Arena* Active();
+
+private:
+    // блок памяти арены
+    struct Block {
+        std::unique_ptr<unsigned char[]> data;
+        size_t size = 0;
+        size_t used = 0;
+    };
+
+    // добавляет блок размером не меньше min_size
+    Block& AddBlock(size_t min_size);
+
+    std::vector<Block> blocks_;
+};
+
+}  // namespace runtime
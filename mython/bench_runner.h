@@ -0,0 +1,44 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+class BenchRunner {
+public:
+    // Прогревает workload одним запуском, затем выполняет его reps раз
+    // и печатает в stdout строку результата в машиночитаемом виде:
+    //     name<TAB>reps<TAB>total_ns<TAB>items<TAB>ns_per_item<TAB>items_per_sec
+    // items - количество учётных единиц (токенов, инструкций, вызовов)
+    // за один запуск workload
+    template <class BenchFunc>
+    void RunBench(BenchFunc func, const std::string& name, int reps, uint64_t items) {
+        using namespace std::chrono;
+
+        func();  // прогрев
+
+        const auto start = steady_clock::now();
+        for (int i = 0; i < reps; ++i) {
+            func();
+        }
+        const auto total_ns = static_cast<uint64_t>(
+            duration_cast<nanoseconds>(steady_clock::now() - start).count());
+
+        const uint64_t total_items = items * static_cast<uint64_t>(reps);
+        const double ns_per_item = total_items != 0
+            ? static_cast<double>(total_ns) / static_cast<double>(total_items) : 0.0;
+        const double items_per_sec = total_ns != 0
+            ? static_cast<double>(total_items) * 1e9 / static_cast<double>(total_ns) : 0.0;
+
+        std::cout << name << "\t" << reps << "\t" << total_ns << "\t" << total_items
+                  << "\t" << ns_per_item << "\t" << items_per_sec << std::endl;
+    }
+
+    // Печатает заголовок таблицы результатов
+    static void PrintHeader() {
+        std::cout << "name\treps\ttotal_ns\titems\tns_per_item\titems_per_sec" << std::endl;
+    }
+};
+
+#define RUN_BENCH(br, func, reps, items) br.RunBench(func, #func, reps, items)
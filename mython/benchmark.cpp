@@ -0,0 +1,138 @@
+#include "bench_runner.h"
+#include "lexer.h"
+#include "parse.h"
+#include "runtime.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+
+using namespace std;
+
+namespace {
+
+// счётчик обращений к куче - позволяет измерять аллокации на один
+// запуск рабочей нагрузки (областей арены он не видит, см. arena.h)
+atomic<uint64_t> heap_allocations{0};
+
+uint64_t HeapAllocations() {
+    return heap_allocations.load(memory_order_relaxed);
+}
+
+// Собирает исходный текст из line_count одинаковых строк
+string MakeFlatSource(int line_count) {
+    string source;
+    for (int i = 0; i < line_count; ++i) {
+        source += "x = 1 + 2 * 3 - 4\n";
+    }
+    return source;
+}
+
+// Программа с циклом: iterations вызовов метода через ClassInstance::Call
+string MakeCallSource(int iterations) {
+    ostringstream os;
+    os << R"(class Counter:
+  def __init__():
+    self.value = 0
+  def add(x):
+    self.value = self.value + x
+
+c = Counter()
+i = 0
+while i < )" << iterations << R"(:
+  c.add(1)
+  i = i + 1
+)";
+    return os.str();
+}
+
+// Считает токены в source, чтобы нормировать результат лексера
+uint64_t CountTokens(const string& source) {
+    parse::Lexer lexer{string_view(source)};
+    uint64_t count = 1;  // текущий токен
+    while (!lexer.CurrentToken().Is<parse::token_type::Eof>()) {
+        lexer.NextToken();
+        ++count;
+    }
+    return count;
+}
+
+void BenchAll() {
+    BenchRunner br;
+    BenchRunner::PrintHeader();
+
+    const string flat_source = MakeFlatSource(10'000);
+    const uint64_t token_count = CountTokens(flat_source);
+
+    // токены в секунду: полный проход лексера по буферу
+    auto bench_lexer = [&flat_source] {
+        parse::Lexer lexer{string_view(flat_source)};
+        while (!lexer.CurrentToken().Is<parse::token_type::Eof>()) {
+            lexer.NextToken();
+        }
+    };
+    RUN_BENCH(br, bench_lexer, 20, token_count);
+
+    // инструкции в секунду: разбор программы целиком
+    auto bench_parser = [&flat_source] {
+        parse::Lexer lexer{string_view(flat_source)};
+        CompiledProgram program(lexer);
+    };
+    RUN_BENCH(br, bench_parser, 20, 10'000);
+
+    // вызовы метода в секунду: цикл с вызовом Counter.add
+    constexpr int CALL_COUNT = 100'000;
+    const string call_source = MakeCallSource(CALL_COUNT);
+    parse::Lexer call_lexer{string_view(call_source)};
+    CompiledProgram call_program(call_lexer);
+
+    ostringstream sink;
+    auto bench_calls = [&call_program, &sink] {
+        runtime::SimpleContext context{sink};
+        runtime::Closure closure;
+        call_program.Run(closure, context);
+    };
+    RUN_BENCH(br, bench_calls, 5, CALL_COUNT);
+
+    // аллокации кучи на один вызов метода
+    {
+        runtime::SimpleContext context{sink};
+        runtime::Closure closure;
+        const uint64_t before = HeapAllocations();
+        call_program.Run(closure, context);
+        const uint64_t allocs = HeapAllocations() - before;
+        cout << "bench_calls_heap_allocs\t1\t0\t" << allocs << "\t"
+             << static_cast<double>(allocs) / CALL_COUNT << "\t0" << endl;
+    }
+}
+
+}  // namespace
+
+void* operator new(size_t size) {
+    heap_allocations.fetch_add(1, memory_order_relaxed);
+    if (void* ptr = malloc(size)) {
+        return ptr;
+    }
+    throw bad_alloc{};
+}
+
+void operator delete(void* ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t /*size*/) noexcept {
+    free(ptr);
+}
+
+int main() {
+    try {
+        BenchAll();
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -1,7 +1,9 @@
 #include "lexer.h"
 
 #include <algorithm>
+#include <array>
 #include <charconv>
+#include <system_error>
 #include <unordered_map>
 
 using namespace std;
@@ -33,6 +35,86 @@ bool operator!=(const Token& lhs, const Token& rhs) {
     return !(lhs == rhs);
 }
 
+LexerError::LexerError(std::string context, int source_line)
+    : runtime_error(""s),
+      context_(std::move(context)),
+      source_line_(source_line) {
+}
+
+LexerError::LexerError(std::string context, Token actual, int source_line)
+    : runtime_error(""s),
+      context_(std::move(context)),
+      actual_(std::move(actual)),
+      source_line_(source_line) {
+}
+
+const char* LexerError::what() const noexcept {
+    if (source_line_ == 0) {
+        // ошибка без привязки к исходному тексту
+        return runtime_error::what();
+    }
+    if (message_.empty()) {
+        try {
+            ostringstream os;
+            os << context_;
+            if (actual_.has_value()) {
+                os << " " << *actual_;
+            }
+            os << " at line " << source_line_;
+            message_ = os.str();
+        } catch (...) {
+            return context_.c_str();
+        }
+    }
+    return message_.c_str();
+}
+
+namespace {
+
+// класс символа: по первому байту сразу выбирается нужный сканер,
+// без каскада проверок на каждый символ
+enum class CharClass : uint8_t {
+    Other,    // всё прочее (пропускается)
+    Space,    // пробел
+    NewLine,  // перевод строки
+    Quote,    // начало строковой константы
+    Word,     // начало идентификатора или ключевого слова
+    Digit,    // начало числа
+    Hash,     // начало комментария
+    Punct,    // одиночный символ или двухсимвольная операция
+};
+
+constexpr array<CharClass, 256> BuildCharClassTable() {
+    array<CharClass, 256> table{};
+    for (int ch = 33; ch < 127; ++ch) {
+        table[ch] = CharClass::Punct;
+    }
+    for (int ch = 'a'; ch <= 'z'; ++ch) {
+        table[ch] = CharClass::Word;
+    }
+    for (int ch = 'A'; ch <= 'Z'; ++ch) {
+        table[ch] = CharClass::Word;
+    }
+    for (int ch = '0'; ch <= '9'; ++ch) {
+        table[ch] = CharClass::Digit;
+    }
+    table['_'] = CharClass::Word;
+    table['\''] = CharClass::Quote;
+    table['\"'] = CharClass::Quote;
+    table['#'] = CharClass::Hash;
+    table[' '] = CharClass::Space;
+    table['\n'] = CharClass::NewLine;
+    return table;
+}
+
+constexpr array<CharClass, 256> CHAR_CLASS = BuildCharClassTable();
+
+CharClass ClassOf(char ch) {
+    return CHAR_CLASS[static_cast<unsigned char>(ch)];
+}
+
+}  // namespace
+
 std::ostream& operator<<(std::ostream& os, const Token& rhs) {
     using namespace token_type;
 
@@ -53,6 +135,7 @@ std::ostream& operator<<(std::ostream& os, const Token& rhs) {
     UNVALUED_OUTPUT(Return);
     UNVALUED_OUTPUT(If);
     UNVALUED_OUTPUT(Else);
+    UNVALUED_OUTPUT(While);
     UNVALUED_OUTPUT(Def);
     UNVALUED_OUTPUT(Newline);
     UNVALUED_OUTPUT(Print);
@@ -75,36 +158,103 @@ std::ostream& operator<<(std::ostream& os, const Token& rhs) {
     return os << "Unknown token :("sv;
 }
 
-Lexer::Lexer(istream& input) : token_input_(input) {
-    current_token_ = vct_tokens_.begin();
+Lexer::Lexer(istream& input, Mode mode) : token_input_(&input) {
+    mode_ = mode;
+    pos_ = 0;
+    dent_ = 0;
+    finalized_ = false;
+
+    if (mode_ == Mode::Eager) {
+        ParseTokens();
+    }
+    else {
+        // потоковый режим: разбираем ровно столько, чтобы был текущий токен
+        TrimSpaces(*token_input_);
+        LexMore();
+    }
+}
+
+Lexer::Lexer(string_view source) : token_input_(nullptr) {
+    mode_ = Mode::Eager;
+    source_ = source;
+    pos_ = 0;
     dent_ = 0;
+    finalized_ = false;
 
-    ParseTokens();
+    ParseBufferTokens();
 }
 
 const Token& Lexer::CurrentToken() const {
-        return *current_token_;
+        return vct_tokens_[pos_];
+}
+
+int Lexer::CurrentLine() const {
+    if (pos_ < vct_lines_.size()) {
+        return vct_lines_[pos_];
+    }
+    return line_;
 }
 
 Token Lexer::NextToken() {
-    if (vct_tokens_.end() == (current_token_+1)) {
-        return *current_token_;
+    if (pos_ + 1 >= vct_tokens_.size()) {
+        if (mode_ == Mode::Streaming) {
+            LexMore();
+        }
+        if (pos_ + 1 >= vct_tokens_.size()) {
+            return vct_tokens_[pos_];
+        }
+    }
+    ++pos_;
+    if ((mode_ == Mode::Streaming) && (pos_ > 1)) {
+        // употреблённые токены больше не нужны - не копим весь поток.
+        // Предыдущий токен сохраняем: на него могут остаться ссылки
+        vct_tokens_.pop_front();
+        vct_lines_.pop_front();
+        --pos_;
     }
-    return *(++current_token_);
+    return vct_tokens_[pos_];
 }
 
 void Lexer::ParseTokens() {
-    TrimSpaces(token_input_);
+    istream& in = *token_input_;
+    TrimSpaces(in);
+
+    while (in) {
+        ParseString(in);
+        ParseKeywords(in);
+        ParseChars(in);
+        ParseNumbers(in);
+        TrimSpaces(in);
+        ParseNewLine(in);
+    }
+
+    FinalizeTokens();
+    SyncLines();
+
+    pos_ = 0;
+}
 
-    while (token_input_) {
-        ParseString(token_input_);
-        ParseKeywords(token_input_);
-        ParseChars(token_input_);
-        ParseNumbers(token_input_);
-        TrimSpaces(token_input_);
-        ParseNewLine(token_input_);
+void Lexer::LexMore() {
+    istream& in = *token_input_;
+    size_t had_tokens = vct_tokens_.size();
+    while (in && (vct_tokens_.size() == had_tokens)) {
+        // одна итерация может не дать ни одного токена
+        // (например, строка-комментарий) - повторяем до первого токена
+        ParseString(in);
+        ParseKeywords(in);
+        ParseChars(in);
+        ParseNumbers(in);
+        TrimSpaces(in);
+        ParseNewLine(in);
+    }
+    if (!in && !finalized_) {
+        FinalizeTokens();
+        finalized_ = true;
     }
+    SyncLines();
+}
 
+void Lexer::FinalizeTokens() {
     if (!vct_tokens_.empty() && (!vct_tokens_.back().Is<token_type::Newline>())) {
         vct_tokens_.emplace_back(token_type::Newline{});
     }
@@ -115,8 +265,6 @@ void Lexer::ParseTokens() {
     }
 
     vct_tokens_.emplace_back(token_type::Eof{});
-
-    current_token_ = vct_tokens_.begin();
 }
 
 void Lexer::TrimSpaces(istream& in) {
@@ -168,63 +316,73 @@ void Lexer::ParseString(istream& in) {
         return;
     }
     char begin = in.get();
-    if ((begin == '\'') || (begin == '\"'))
-    {
-        char ch;
-        string result;
-        while (in.get(ch)) {
-            if (ch == begin) {
-                break;
-            }
-            else if (ch == '\\') {
-                char esc_ch;
-                if (in.get(esc_ch))
-                {
-                    switch (esc_ch)
-                    {
-                    case 'n':
-                        result.push_back('\n');
-                        break;
-                    case 't':
-                        result.push_back('\t');
-                        break;
-                    case 'r':
-                        result.push_back('\r');
-                        break;
-                    case '"':
-                        result.push_back('"');
-                        break;
-                    case '\'':
-                        result.push_back('\'');
-                        break;
-                    case '\\':
-                        result.push_back('\\');
-                        break;
-                    default:
-                        throw LexerError(string(__func__) + " is failed at " + to_string(__LINE__));
-                    }
-                }
-                else {
-                    throw LexerError(string(__func__) + " is failed at " + to_string(__LINE__));
-                }
-            }
-            else if ((ch == '\n') || (ch == '\r')) {
-                throw LexerError(string(__func__) + " is failed at " + to_string(__LINE__));
+    if ((begin != '\'') && (begin != '\"')) {
+        in.putback(begin);
+        return;
+    }
+
+    // читаем литерал до закрывающей кавычки блоками, а не по символу.
+    // Кавычка после нечётного числа '\\' экранирована и принадлежит литералу
+    string raw;
+    string chunk;
+    while (true) {
+        getline(in, chunk, begin);
+        if (!in || in.eof()) {
+            // конец ввода раньше закрывающей кавычки
+            throw LexerError("unterminated string literal"s, line_);
+        }
+        raw += chunk;
+        size_t slashes = 0;
+        while ((slashes < raw.size()) && (raw[raw.size() - 1 - slashes] == '\\')) {
+            ++slashes;
+        }
+        if (slashes % 2 == 0) {
+            break;
+        }
+        raw.push_back(begin);
+    }
+
+    // единый проход по блоку: раскрываем экранирование
+    string result;
+    result.reserve(raw.size());
+    for (size_t i = 0; i < raw.size(); ++i) {
+        char ch = raw[i];
+        if (ch == '\\') {
+            if (++i >= raw.size()) {
+                throw LexerError("bad escape sequence"s, line_);
             }
-            else {
-                result.push_back(ch);
+            switch (raw[i])
+            {
+            case 'n':
+                result.push_back('\n');
+                break;
+            case 't':
+                result.push_back('\t');
+                break;
+            case 'r':
+                result.push_back('\r');
+                break;
+            case '\"':
+                result.push_back('\"');
+                break;
+            case '\'':
+                result.push_back('\'');
+                break;
+            case '\\':
+                result.push_back('\\');
+                break;
+            default:
+                throw LexerError("bad escape sequence"s, line_);
             }
         }
-        if (begin == ch) {
-            vct_tokens_.emplace_back(token_type::String{ result });
+        else if ((ch == '\n') || (ch == '\r')) {
+            throw LexerError("newline in string literal"s, line_);
         }
         else {
-            throw LexerError(string(__func__) + " is failed at " + to_string(__LINE__));
+            result.push_back(ch);
         }
     }
-    else {
-        in.putback(begin);
-    }
+    vct_tokens_.emplace_back(token_type::String{ move(result) });
 }
 
 void Lexer::ParseKeywords(istream& in) {
@@ -245,45 +403,7 @@ void Lexer::ParseKeywords(istream& in) {
                 break;
             }
         }
-        if (!keyword.compare("class")) {
-            vct_tokens_.emplace_back(token_type::Class{});
-        }
-        else if (!keyword.compare("return")) {
-            vct_tokens_.emplace_back(token_type::Return{});
-        }
-        else if (!keyword.compare("if")) {
-            vct_tokens_.emplace_back(token_type::If{});
-        }
-        else if (!keyword.compare("else")) {
-            vct_tokens_.emplace_back(token_type::Else{});
-        }
-        else if (!keyword.compare("def")) {
-            vct_tokens_.emplace_back(token_type::Def{});
-        }
-        else if (!keyword.compare("print")) {
-            vct_tokens_.emplace_back(token_type::Print{});
-        }
-        else if (!keyword.compare("and")) {
-            vct_tokens_.emplace_back(token_type::And{});
-        }
-        else if (!keyword.compare("or")) {
-            vct_tokens_.emplace_back(token_type::Or{});
-        }
-        else if (!keyword.compare("not")) {
-            vct_tokens_.emplace_back(token_type::Not{});
-        }
-        else if (!keyword.compare("None")) {
-            vct_tokens_.emplace_back(token_type::None{});
-        }
-        else if (!keyword.compare("True")) {
-            vct_tokens_.emplace_back(token_type::True{});
-        }
-        else if (!keyword.compare("False")) {
-            vct_tokens_.emplace_back(token_type::False{});
-        }
-        else {
-            vct_tokens_.emplace_back(token_type::Id{keyword});
-        }
+        EmitWord(keyword);
     }
 }
 
@@ -330,17 +450,11 @@ void Lexer::ParseNumbers(istream& in) {
     }
     char ch = in.peek();
     if (isdigit(ch)) {
-        string result;
-        while (in.get(ch)) {
-            if (isdigit(ch)) {
-                result.push_back(ch);
-            }
-            else {
-                in.putback(ch);
-                break;
-            }
+        // разбор средствами потока, без промежуточной строки
+        int num = 0;
+        if (!(in >> num)) {
+            throw LexerError("invalid number"s, line_);
         }
-        int num = stoi(result);
         vct_tokens_.emplace_back(token_type::Number{ num });
     }
 }
@@ -352,10 +466,306 @@ void Lexer::ParseNewLine(istream& in) {
         if (!vct_tokens_.empty() && (!vct_tokens_.back().Is<token_type::Newline>())) {
             vct_tokens_.emplace_back(token_type::Newline{});
         }
+        // токены до перевода строки относятся к текущей строке
+        SyncLines();
+        ++line_;
         ParseDent(in);
     }
 }
 
+void Lexer::SyncLines() {
+    while (vct_lines_.size() < vct_tokens_.size()) {
+        vct_lines_.push_back(line_);
+    }
+}
+
+void Lexer::ParseBufferTokens() {
+    const char* p = source_.data();
+    const char* end = p + source_.size();
+
+    // пробелы в начале первой строки отступом не считаются
+    while ((p < end) && (*p == ' ')) {
+        ++p;
+    }
+
+    while (p < end) {
+        switch (ClassOf(*p)) {
+        case CharClass::Quote:
+            p = ScanStringBuf(p, end);
+            break;
+        case CharClass::Word:
+            p = ScanWordBuf(p, end);
+            break;
+        case CharClass::Digit:
+            p = ScanNumberBuf(p, end);
+            break;
+        case CharClass::Hash:
+            // комментарий до конца строки
+            while ((p < end) && (*p != '\n')) {
+                ++p;
+            }
+            break;
+        case CharClass::NewLine:
+            if (!vct_tokens_.empty() && (!vct_tokens_.back().Is<token_type::Newline>())) {
+                vct_tokens_.emplace_back(token_type::Newline{});
+            }
+            // токены до перевода строки относятся к текущей строке
+            SyncLines();
+            ++line_;
+            ++p;
+            p = ScanDentBuf(p, end);
+            break;
+        case CharClass::Punct:
+            p = ScanCharBuf(p, end);
+            break;
+        case CharClass::Space:
+        case CharClass::Other:
+            ++p;
+            break;
+        }
+    }
+
+    FinalizeTokens();
+    SyncLines();
+
+    pos_ = 0;
+}
+
+const char* Lexer::ScanStringBuf(const char* p, const char* end) {
+    char begin = *p;
+    ++p;
+    string result;
+    while (p < end) {
+        // блок обычных символов до кавычки, экранирования
+        // или конца строки добавляется одним append
+        const char* run = p;
+        while ((p < end) && (*p != begin) && (*p != '\\')
+               && (*p != '\n') && (*p != '\r')) {
+            ++p;
+        }
+        result.append(run, p);
+        if (p >= end) {
+            break;
+        }
+        char ch = *p;
+        if (ch == begin) {
+            vct_tokens_.emplace_back(token_type::String{ move(result) });
+            return p + 1;
+        }
+        if (ch == '\\') {
+            ++p;
+            if (p >= end) {
+                break;
+            }
+            switch (*p) {
+            case 'n':
+                result.push_back('\n');
+                break;
+            case 't':
+                result.push_back('\t');
+                break;
+            case 'r':
+                result.push_back('\r');
+                break;
+            case '\"':
+                result.push_back('\"');
+                break;
+            case '\'':
+                result.push_back('\'');
+                break;
+            case '\\':
+                result.push_back('\\');
+                break;
+            default:
+                throw LexerError("bad escape sequence"s, line_);
+            }
+            ++p;
+        }
+        else {
+            throw LexerError("newline in string literal"s, line_);
+        }
+    }
+    throw LexerError("unterminated string literal"s, line_);
+}
+
+const char* Lexer::ScanWordBuf(const char* p, const char* end) {
+    const char* word_begin = p;
+    while ((p < end)
+           && ((ClassOf(*p) == CharClass::Word) || (ClassOf(*p) == CharClass::Digit))) {
+        ++p;
+    }
+    EmitWord(string_view(word_begin, static_cast<size_t>(p - word_begin)));
+    return p;
+}
+
+const char* Lexer::ScanNumberBuf(const char* p, const char* end) {
+    int num = 0;
+    auto [ptr, ec] = from_chars(p, end, num);
+    if (ec != errc()) {
+        throw LexerError("invalid number"s, line_);
+    }
+    vct_tokens_.emplace_back(token_type::Number{ num });
+    return ptr;
+}
+
+const char* Lexer::ScanCharBuf(const char* p, const char* end) {
+    char ch = *p;
+    ++p;
+    if ((ch == '=') && (p < end) && (*p == '=')) {
+        vct_tokens_.emplace_back(token_type::Eq{});
+        return p + 1;
+    }
+    if ((ch == '!') && (p < end) && (*p == '=')) {
+        vct_tokens_.emplace_back(token_type::NotEq{});
+        return p + 1;
+    }
+    if ((ch == '>') && (p < end) && (*p == '=')) {
+        vct_tokens_.emplace_back(token_type::GreaterOrEq{});
+        return p + 1;
+    }
+    if ((ch == '<') && (p < end) && (*p == '=')) {
+        vct_tokens_.emplace_back(token_type::LessOrEq{});
+        return p + 1;
+    }
+    vct_tokens_.emplace_back(token_type::Char{ ch });
+    return p;
+}
+
+const char* Lexer::ScanDentBuf(const char* p, const char* end) {
+    int spaces_processed = 0;
+    while ((p < end) && (*p == ' ')) {
+        ++spaces_processed;
+        ++p;
+    }
+    if ((p == end) || (*p == '\n')) {
+        // пустая строка (или конец ввода) отступы не меняет:
+        // завершающие Dedent добавит FinalizeTokens
+        return p;
+    }
+    if (dent_*DENT_SPACES < spaces_processed) {
+        spaces_processed -= dent_*DENT_SPACES;
+        while (spaces_processed > 0) {
+            spaces_processed -= DENT_SPACES;
+            vct_tokens_.emplace_back(token_type::Indent{});
+            ++dent_;
+        }
+    }
+    else if (dent_*DENT_SPACES > spaces_processed)
+    {
+        spaces_processed = dent_*DENT_SPACES - spaces_processed;
+        while (spaces_processed > 0) {
+            spaces_processed -= DENT_SPACES;
+            vct_tokens_.emplace_back(token_type::Dedent{});
+            --dent_;
+        }
+    }
+    return p;
+}
+
+void Lexer::EmitWord(string_view word) {
+    // ключевые слова различаются по длине и первому символу,
+    // так что для распознавания хватает двух переходов и одного сравнения
+    switch (word.size()) {
+    case 2:
+        if (word == "if"sv) {
+            vct_tokens_.emplace_back(token_type::If{});
+            return;
+        }
+        if (word == "or"sv) {
+            vct_tokens_.emplace_back(token_type::Or{});
+            return;
+        }
+        break;
+    case 3:
+        switch (word.front()) {
+        case 'd':
+            if (word == "def"sv) {
+                vct_tokens_.emplace_back(token_type::Def{});
+                return;
+            }
+            break;
+        case 'a':
+            if (word == "and"sv) {
+                vct_tokens_.emplace_back(token_type::And{});
+                return;
+            }
+            break;
+        case 'n':
+            if (word == "not"sv) {
+                vct_tokens_.emplace_back(token_type::Not{});
+                return;
+            }
+            break;
+        default:
+            break;
+        }
+        break;
+    case 4:
+        switch (word.front()) {
+        case 'e':
+            if (word == "else"sv) {
+                vct_tokens_.emplace_back(token_type::Else{});
+                return;
+            }
+            break;
+        case 'N':
+            if (word == "None"sv) {
+                vct_tokens_.emplace_back(token_type::None{});
+                return;
+            }
+            break;
+        case 'T':
+            if (word == "True"sv) {
+                vct_tokens_.emplace_back(token_type::True{});
+                return;
+            }
+            break;
+        default:
+            break;
+        }
+        break;
+    case 5:
+        switch (word.front()) {
+        case 'c':
+            if (word == "class"sv) {
+                vct_tokens_.emplace_back(token_type::Class{});
+                return;
+            }
+            break;
+        case 'p':
+            if (word == "print"sv) {
+                vct_tokens_.emplace_back(token_type::Print{});
+                return;
+            }
+            break;
+        case 'w':
+            if (word == "while"sv) {
+                vct_tokens_.emplace_back(token_type::While{});
+                return;
+            }
+            break;
+        case 'F':
+            if (word == "False"sv) {
+                vct_tokens_.emplace_back(token_type::False{});
+                return;
+            }
+            break;
+        default:
+            break;
+        }
+        break;
+    case 6:
+        if (word == "return"sv) {
+            vct_tokens_.emplace_back(token_type::Return{});
+            return;
+        }
+        break;
+    default:
+        break;
+    }
+    vct_tokens_.emplace_back(token_type::Id{ string(word) });
+}
+
 void Lexer::ParseComments(istream& in) {
     char ch = in.peek();
     if (ch == '#') {
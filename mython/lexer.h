@@ -1,10 +1,12 @@
 #pragma once
 
+#include <deque>
 #include <iosfwd>
 #include <optional>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <variant>
 #include <vector>
 
@@ -31,6 +33,7 @@ struct Class {};    // Лексема «class»
 struct Return {};   // Лексема «return»
 struct If {};       // Лексема «if»
 struct Else {};     // Лексема «else»
+struct While {};    // Лексема «while»
 struct Def {};      // Лексема «def»
 struct Newline {};  // Лексема «конец строки»
 struct Print {};    // Лексема «print»
@@ -52,6 +55,7 @@ struct False {};        // Лексема «False»
 using TokenBase
     = std::variant<token_type::Number, token_type::Id, token_type::Char, token_type::String,
                    token_type::Class, token_type::Return, token_type::If, token_type::Else,
+                   token_type::While,
                    token_type::Def, token_type::Newline, token_type::Print, token_type::Indent,
                    token_type::Dedent, token_type::And, token_type::Or, token_type::Not,
                    token_type::Eq, token_type::NotEq, token_type::LessOrEq, token_type::GreaterOrEq,
@@ -81,9 +85,34 @@ bool operator!=(const Token& lhs, const Token& rhs);
 
 std::ostream& operator<<(std::ostream& os, const Token& rhs);
 
+/*
+ * Ошибка лексического разбора. Может нести фактический токен и номер
+ * строки исходного текста Mython; сообщение из них форматируется лениво,
+ * при первом обращении к what(), поэтому на пути успешного разбора
+ * не строится ни одной строки
+ */
 class LexerError : public std::runtime_error {
 public:
     using std::runtime_error::runtime_error;
+
+    // ошибка в строке source_line исходного текста
+    LexerError(std::string context, int source_line);
+    // ошибка в строке source_line: вместо ожидаемого встретился actual
+    LexerError(std::string context, Token actual, int source_line);
+
+    [[nodiscard]] const char* what() const noexcept override;
+
+    // строка исходного текста с ошибкой (0 - неизвестна)
+    [[nodiscard]] int SourceLine() const {
+        return source_line_;
+    }
+
+private:
+    std::string context_;
+    std::optional<Token> actual_;
+    int source_line_ = 0;
+    // сообщение, собранное при первом обращении к what()
+    mutable std::string message_;
 };
 
 // пробелов на отступ
@@ -91,11 +120,26 @@ constexpr int DENT_SPACES = 2;
 
 class Lexer {
 public:
-    explicit Lexer(std::istream& input);
+    // режим работы лексера
+    enum class Mode {
+        Eager,      // весь ввод разбирается на токены в конструкторе
+        Streaming,  // токены разбираются по требованию в NextToken()
+    };
+
+    explicit Lexer(std::istream& input, Mode mode = Mode::Eager);
+
+    // Разбирает программу напрямую из буфера source (например, из
+    // отображённого в память файла), не используя потоковый ввод.
+    // Буфер должен жить, пока жив лексер
+    explicit Lexer(std::string_view source);
 
     // Возвращает ссылку на текущий токен или token_type::Eof, если поток токенов закончился
     [[nodiscard]] const Token& CurrentToken() const;
 
+    // Возвращает номер строки исходного текста (с единицы),
+    // на которой находится текущий токен
+    [[nodiscard]] int CurrentLine() const;
+
     // Возвращает следующий токен, либо token_type::Eof, если поток токенов закончился
     Token NextToken();
 
@@ -120,17 +164,44 @@ public:
     void ExpectNext(const U& value);
 
 private:
-    // входной поток
-    std::istream& token_input_;
-    // вектор токенов
-    std::vector<Token> vct_tokens_;
-    // текущий токен
-    std::vector<Token>::const_iterator current_token_;
+    // входной поток (nullptr при разборе из буфера)
+    std::istream* token_input_;
+    // входной буфер (режим разбора из буфера)
+    std::string_view source_;
+    // режим работы
+    Mode mode_;
+    // разобранные, но ещё не употреблённые токены.
+    // В потоковом режиме употреблённые токены отбрасываются
+    std::deque<Token> vct_tokens_;
+    // номера строк токенов, параллельно vct_tokens_
+    std::deque<int> vct_lines_;
+    // номер текущей строки входного текста при разборе
+    int line_ = 1;
+    // позиция текущего токена в vct_tokens_
+    size_t pos_;
     // отступ
     int dent_;
+    // был ли уже разобран конец ввода (потоковый режим)
+    bool finalized_;
 
     // парсинг токенов
     void ParseTokens();
+    // в потоковом режиме разбирает следующую порцию токенов
+    void LexMore();
+    // добавляет завершающие Newline, Dedent и Eof
+    void FinalizeTokens();
+    // дополняет vct_lines_ номерами строк для новых токенов
+    void SyncLines();
+    // разбирает весь буфер source_ на токены
+    void ParseBufferTokens();
+    // сканеры по сырому буферу: возвращают позицию после токена
+    const char* ScanStringBuf(const char* p, const char* end);
+    const char* ScanWordBuf(const char* p, const char* end);
+    const char* ScanNumberBuf(const char* p, const char* end);
+    const char* ScanCharBuf(const char* p, const char* end);
+    const char* ScanDentBuf(const char* p, const char* end);
+    // добавляет токен для слова word - ключевого слова или идентификатора
+    void EmitWord(std::string_view word);
     // обрезка пробелов
     void TrimSpaces(std::istream& in);
     // парсинг отступов
@@ -156,13 +227,13 @@ const T& Lexer::Expect() const {
     if (CurrentToken().Is<T>()) {
         return CurrentToken().As<T>();
     }
-    throw LexerError(std::string(__func__) + " is failed at " + std::to_string(__LINE__));
+    throw LexerError(std::string("unexpected token"), CurrentToken(), CurrentLine());
 }
 
 template <typename T, typename U>
 void Lexer::Expect(const U& value) const {
     if (Expect<T>().value != value) {
-        throw LexerError(std::string(__func__) + " is failed at " + std::to_string(__LINE__));
+        throw LexerError(std::string("unexpected token value"), CurrentToken(), CurrentLine());
     }
 }
 
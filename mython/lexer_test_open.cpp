@@ -351,6 +351,56 @@ abc#
         ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Eof{}));
     }
 }
+void TestStreamingMode() {
+    const string input_text = R"(
+class Fib:
+  def calc(n):
+    if n < 2:
+      return n
+    # comment
+    return self.calc(n - 1) + self.calc(n - 2)
+
+fib = Fib()
+print fib.calc(10)
+)"s;
+
+    // потоковый лексер выдаёт ту же последовательность токенов, что и жадный
+    istringstream eager_input(input_text);
+    istringstream streaming_input(input_text);
+    Lexer eager(eager_input);
+    Lexer streaming(streaming_input, Lexer::Mode::Streaming);
+
+    ASSERT_EQUAL(eager.CurrentToken(), streaming.CurrentToken());
+    while (!eager.CurrentToken().Is<token_type::Eof>()) {
+        ASSERT_EQUAL(eager.NextToken(), streaming.NextToken());
+    }
+    // после Eof оба лексера продолжают возвращать Eof
+    ASSERT_EQUAL(eager.NextToken(), streaming.NextToken());
+}
+
+void TestStringViewMode() {
+    const string input_text = R"(
+class Point:
+  def __init__(x, y):
+    self.x = x
+    self.y = y
+
+# comment
+p = Point(1, 20 / 4)
+print p.x <= p.y, 'x\ty'
+)"s;
+
+    // лексер по буферу выдаёт ту же последовательность токенов, что и потоковый
+    istringstream stream_input(input_text);
+    Lexer by_stream(stream_input);
+    Lexer by_buffer{string_view(input_text)};
+
+    ASSERT_EQUAL(by_stream.CurrentToken(), by_buffer.CurrentToken());
+    while (!by_stream.CurrentToken().Is<token_type::Eof>()) {
+        ASSERT_EQUAL(by_stream.NextToken(), by_buffer.NextToken());
+    }
+}
+
 }  // namespace
 
 void RunOpenLexerTests(TestRunner& tr) {
@@ -367,6 +417,8 @@ void RunOpenLexerTests(TestRunner& tr) {
     RUN_TEST(tr, parse::TestMythonProgram);
     RUN_TEST(tr, parse::TestAlwaysEmitsNewlineAtTheEndOfNonemptyLine);
     RUN_TEST(tr, parse::TestCommentsAreIgnored);
+    RUN_TEST(tr, parse::TestStreamingMode);
+    RUN_TEST(tr, parse::TestStringViewMode);
 }
 
 }  // namespace parse
\ No newline at end of file
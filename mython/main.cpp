@@ -4,7 +4,17 @@
 #include "statement.h"
 #include "test_runner.h"
 
+#include <atomic>
+#include <charconv>
+#include <fstream>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 using namespace std;
 
@@ -20,17 +30,21 @@ void RunObjectHolderTests(TestRunner& tr);
 void RunObjectsTests(TestRunner& tr);
 }  // namespace runtime
 
+namespace vm {
+void RunVmTests(TestRunner& tr);
+}  // namespace vm
+
 void TestParseProgram(TestRunner& tr);
 
 namespace {
 
 void RunMythonProgram(istream& input, ostream& output) {
     parse::Lexer lexer(input);
-    auto program = ParseProgram(lexer);
+    CompiledProgram program(lexer);
 
     runtime::SimpleContext context{output};
     runtime::Closure closure;
-    program->Execute(closure, context);
+    program.Run(closure, context);
 }
 
 void TestSimplePrints() {
@@ -118,6 +132,7 @@ void TestAll() {
     runtime::RunObjectsTests(tr);
     ast::RunUnitTests(tr);
     TestParseProgram(tr);
+    vm::RunVmTests(tr);
 
     RUN_TEST(tr, TestSimplePrints);
     RUN_TEST(tr, TestAssignments);
@@ -125,16 +140,174 @@ void TestAll() {
     RUN_TEST(tr, TestVariablesArePointers);
 }
 
+// задание пакетного режима: скрипт и файл для его вывода
+struct BatchJob {
+    string script;
+    string output;
+};
+
+// Выполняет задания из манифеста (строки вида "скрипт вывод") на пуле
+// из jobs рабочих потоков. Каждый скрипт компилируется один раз, и все
+// потоки разделяют скомпилированные программы только для чтения; своё
+// замыкание и контекст у каждого запуска собственные.
+// Возвращает количество неудавшихся заданий
+int RunBatch(const string& manifest_path, unsigned jobs) {
+    ifstream manifest(manifest_path);
+    if (!manifest) {
+        cerr << "Cannot open "sv << manifest_path << endl;
+        return 1;
+    }
+
+    vector<BatchJob> batch;
+    BatchJob job;
+    while (manifest >> job.script >> job.output) {
+        batch.push_back(job);
+    }
+
+    // компилируем каждый скрипт единожды до запуска пула
+    unordered_map<string, unique_ptr<const CompiledProgram>> programs;
+    mutex log_guard;
+    atomic<int> failures{0};
+    for (const auto& item : batch) {
+        if (programs.count(item.script) != 0) {
+            continue;
+        }
+        try {
+            ifstream source(item.script);
+            if (!source) {
+                throw runtime_error("cannot open script"s);
+            }
+            parse::Lexer lexer(source);
+            programs.emplace(item.script, make_unique<const CompiledProgram>(lexer));
+        } catch (const exception& e) {
+            cerr << item.script << ": "sv << e.what() << endl;
+            programs.emplace(item.script, nullptr);
+        }
+    }
+
+    atomic<size_t> next{0};
+    auto worker = [&] {
+        for (size_t i = next++; i < batch.size(); i = next++) {
+            const BatchJob& current = batch[i];
+            const CompiledProgram* program = programs.at(current.script).get();
+            if (program == nullptr) {
+                // скрипт не скомпилировался - задание провалено
+                ++failures;
+                continue;
+            }
+            try {
+                ofstream output(current.output);
+                if (!output) {
+                    throw runtime_error("cannot open output"s);
+                }
+                // крупноблочный вывод: print копится в буфере контекста
+                // и уходит в файл большими блоками
+                runtime::BufferedContext context{output};
+                runtime::Closure closure;
+                program->Run(closure, context);
+            } catch (const exception& e) {
+                ++failures;
+                lock_guard<mutex> lock(log_guard);
+                cerr << current.script << ": "sv << e.what() << endl;
+            }
+        }
+    };
+
+    if (jobs == 0) {
+        jobs = 1;
+    }
+    vector<thread> pool;
+    pool.reserve(jobs);
+    for (unsigned i = 0; i < jobs; ++i) {
+        pool.emplace_back(worker);
+    }
+    for (auto& th : pool) {
+        th.join();
+    }
+
+    return failures;
+}
+
+void PrintUsage(ostream& os) {
+    os << "Usage: mython [--test] [script]"sv << endl;
+    os << "       mython --batch manifest [--jobs N]"sv << endl;
+    os << "  --test   run the embedded self-tests before the program"sv << endl;
+    os << "  script   read the program from file instead of stdin"sv << endl;
+    os << "  --batch  run 'script output' jobs from manifest on a thread pool"sv << endl;
+    os << "  --jobs   number of worker threads (default: hardware concurrency)"sv << endl;
+}
+
 }  // namespace
 
-int main() {
-    try {
-        TestAll();
+int main(int argc, char* argv[]) {
+    bool run_tests = false;
+    string script;
+    string manifest;
+    unsigned jobs = thread::hardware_concurrency();
+
+    for (int i = 1; i < argc; ++i) {
+        string_view arg = argv[i];
+        if (arg == "--test"sv) {
+            run_tests = true;
+        }
+        else if (arg == "--help"sv) {
+            PrintUsage(cout);
+            return 0;
+        }
+        else if (arg == "--batch"sv) {
+            if (i + 1 == argc) {
+                cerr << "Missing --batch value"sv << endl;
+                PrintUsage(cerr);
+                return 1;
+            }
+            manifest = argv[++i];
+        }
+        else if (arg == "--jobs"sv) {
+            if (i + 1 == argc) {
+                cerr << "Missing --jobs value"sv << endl;
+                PrintUsage(cerr);
+                return 1;
+            }
+            string_view value = argv[++i];
+            auto result = from_chars(value.data(), value.data() + value.size(), jobs);
+            if ((result.ec != errc()) || (result.ptr != value.data() + value.size())) {
+                cerr << "Invalid --jobs value "sv << value << endl;
+                PrintUsage(cerr);
+                return 1;
+            }
+        }
+        else if (script.empty()) {
+            script = arg;
+        }
+        else {
+            PrintUsage(cerr);
+            return 1;
+        }
+    }
 
-        RunMythonProgram(cin, cout);
+    try {
+        if (!manifest.empty()) {
+            return RunBatch(manifest, jobs) == 0 ? 0 : 1;
+        }
+
+        if (run_tests) {
+            TestAll();
+        }
+
+        if (!script.empty()) {
+            ifstream input(script);
+            if (!input) {
+                cerr << "Cannot open "sv << script << endl;
+                return 1;
+            }
+            RunMythonProgram(input, cout);
+        }
+        else {
+            RunMythonProgram(cin, cout);
+        }
     } catch (const std::exception& e) {
         std::cerr << e.what() << std::endl;
-		return 1;
+        return 1;
     }
     return 0;
 }
\ No newline at end of file
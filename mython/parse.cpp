@@ -1,10 +1,16 @@
 #include "parse.h"
 
+#include "arena.h"
 #include "lexer.h"
+#include "profile.h"
 #include "statement.h"
 
 using namespace std;
 
+ParseError::ParseError(const string& msg, int source_line)
+    : runtime_error(msg + " at line "s + to_string(source_line)) {
+}
+
 namespace TokenType = parse::token_type;
 
 namespace {
@@ -17,6 +23,61 @@ bool operator!=(const parse::Token& token, char c) {
     return !(token == c);
 }
 
+// возвращает true, если node - константа (число, строка или Bool)
+bool IsConstant(const ast::Statement* node) {
+    return (nullptr != dynamic_cast<const ast::NumericConst*>(node))
+        || (nullptr != dynamic_cast<const ast::StringConst*>(node))
+        || (nullptr != dynamic_cast<const ast::BoolConst*>(node));
+}
+
+// вычисляет узел, не зависящий от переменных и контекста
+runtime::ObjectHolder EvaluateConstant(ast::Statement& node) {
+    runtime::Closure closure;
+    runtime::DummyContext context;
+    return node.Execute(closure, context);
+}
+
+// Сворачивает узел с константными операндами в узел-константу.
+// Если вычисление невозможно (например, деление на ноль), узел
+// остаётся как есть, и ошибка всплывёт при выполнении программы
+unique_ptr<ast::Statement> FoldIfConstant(unique_ptr<ast::Statement> node,
+                                          bool operands_constant) {
+    if (!operands_constant) {
+        return node;
+    }
+    try {
+        runtime::ObjectHolder value = EvaluateConstant(*node);
+        if (const auto* num = value.TryAs<runtime::Number>()) {
+            return make_unique<ast::NumericConst>(num->GetValue());
+        }
+        if (const auto* str = value.TryAs<runtime::String>()) {
+            return make_unique<ast::StringConst>(str->GetValue());
+        }
+        if (const auto* flag = value.TryAs<runtime::Bool>()) {
+            return make_unique<ast::BoolConst>(runtime::Bool(flag->GetValue()));
+        }
+    }
+    catch (...) {
+    }
+    return node;
+}
+
+// создаёт бинарный узел Node, сворачивая его при константных операндах
+template <typename Node>
+unique_ptr<ast::Statement> MakeBinary(unique_ptr<ast::Statement> lhs,
+                                      unique_ptr<ast::Statement> rhs) {
+    bool operands_constant = IsConstant(lhs.get()) && IsConstant(rhs.get());
+    return FoldIfConstant(make_unique<Node>(std::move(lhs), std::move(rhs)),
+                          operands_constant);
+}
+
+// создаёт узел ast::Not, сворачивая его при константном операнде
+unique_ptr<ast::Statement> MakeNot(unique_ptr<ast::Statement> argument) {
+    bool operand_constant = IsConstant(argument.get());
+    return FoldIfConstant(make_unique<ast::Not>(std::move(argument)),
+                          operand_constant);
+}
+
 class Parser {
 public:
     explicit Parser(parse::Lexer& lexer)
@@ -98,7 +159,8 @@ private:
 
             auto it = declared_classes_.find(name);
             if (it == declared_classes_.end()) {
-                throw ParseError("Base class "s + name + " not found for class "s + class_name);
+                throw ParseError("Base class "s + name + " not found for class "s + class_name,
+                                 lexer_.CurrentLine());
             }
             base_class = static_cast<const runtime::Class*>(it->second.Get());  // NOLINT
         }
@@ -118,7 +180,7 @@ private:
         });
 
         if (!inserted) {
-            throw ParseError("Class "s + class_name + " already exists"s);
+            throw ParseError("Class "s + class_name + " already exists"s, lexer_.CurrentLine());
         }
 
         return make_unique<ast::ClassDefinition>(it->second);
@@ -156,7 +218,8 @@ private:
         lexer_.NextToken();
 
         if (id_list.empty()) {
-            throw ParseError("Mython doesn't support functions, only methods: "s + last_name);
+            throw ParseError("Mython doesn't support functions, only methods: "s + last_name,
+                             lexer_.CurrentLine());
         }
 
         vector<unique_ptr<ast::Statement>> args;
@@ -179,9 +242,9 @@ private:
             lexer_.NextToken();
 
             if (op == '+') {
-                result = make_unique<ast::Add>(std::move(result), ParseAdder());
+                result = MakeBinary<ast::Add>(std::move(result), ParseAdder());
             } else {
-                result = make_unique<ast::Sub>(std::move(result), ParseAdder());
+                result = MakeBinary<ast::Sub>(std::move(result), ParseAdder());
             }
         }
         return result;
@@ -196,9 +259,9 @@ private:
             lexer_.NextToken();
 
             if (op == '*') {
-                result = make_unique<ast::Mult>(std::move(result), ParseMult());
+                result = MakeBinary<ast::Mult>(std::move(result), ParseMult());
             } else {
-                result = make_unique<ast::Div>(std::move(result), ParseMult());
+                result = MakeBinary<ast::Div>(std::move(result), ParseMult());
             }
         }
         return result;
@@ -224,7 +287,7 @@ private:
         }
         if (lexer_.CurrentToken() == '-') {
             lexer_.NextToken();
-            return make_unique<ast::Mult>(ParseMult(), make_unique<ast::NumericConst>(-1));
+            return MakeBinary<ast::Mult>(ParseMult(), make_unique<ast::NumericConst>(-1));
         }
         if (const auto* num = lexer_.CurrentToken().TryAs<TokenType::Number>()) {
             int result = num->value;
@@ -278,11 +341,11 @@ private:
             }
             if (method_name == "str"sv) {
                 if (args.size() != 1) {
-                    throw ParseError("Function str takes exactly one argument"s);
+                    throw ParseError("Function str takes exactly one argument"s, lexer_.CurrentLine());
                 }
                 return make_unique<ast::Stringify>(std::move(args.front()));
             }
-            throw ParseError("Unknown call to "s + method_name + "()"s);
+            throw ParseError("Unknown call to "s + method_name + "()"s, lexer_.CurrentLine());
         }
         return make_unique<ast::VariableValue>(std::move(names));
     }
@@ -319,10 +382,53 @@ private:
             else_body = ParseSuite();
         }
 
+        if (IsConstant(condition.get())) {
+            // логическая константа в условии - оставляем только нужную
+            // ветку. Числовую или строковую константу не сворачиваем:
+            // IfElse требует строгого Bool и обязан упасть при выполнении
+            runtime::ObjectHolder value = EvaluateConstant(*condition);
+            if (const auto* flag = value.TryAs<runtime::Bool>()) {
+                if (flag->GetValue()) {
+                    return if_body;
+                }
+                if (else_body) {
+                    return else_body;
+                }
+                return make_unique<ast::Compound>();
+            }
+        }
+
         return make_unique<ast::IfElse>(std::move(condition), std::move(if_body),
                                         std::move(else_body));
     }
 
+    // Loop -> while LogicalExpr: Suite
+    unique_ptr<ast::Statement> ParseWhile()  // NOLINT
+    {
+        lexer_.Expect<TokenType::While>();
+        lexer_.NextToken();
+
+        auto condition = ParseTest();
+
+        lexer_.Expect<TokenType::Char>(':');
+        lexer_.NextToken();
+
+        auto body = ParseSuite();
+
+        if (IsConstant(condition.get())) {
+            // заведомо ложный строгий Bool - цикл не выполнится ни разу.
+            // Прочие константы оставляем: While требует строгого Bool
+            // и обязан упасть при выполнении
+            runtime::ObjectHolder value = EvaluateConstant(*condition);
+            const auto* flag = value.TryAs<runtime::Bool>();
+            if ((flag != nullptr) && !flag->GetValue()) {
+                return make_unique<ast::Compound>();
+            }
+        }
+
+        return make_unique<ast::While>(std::move(condition), std::move(body));
+    }
+
     // LogicalExpr -> AndTest [OR AndTest]
     // AndTest -> NotTest [AND NotTest]
     // NotTest -> [NOT] NotTest
@@ -332,7 +438,7 @@ private:
         auto result = ParseAndTest();
         while (lexer_.CurrentToken().Is<TokenType::Or>()) {
             lexer_.NextToken();
-            result = make_unique<ast::Or>(std::move(result), ParseAndTest());
+            result = MakeBinary<ast::Or>(std::move(result), ParseAndTest());
         }
         return result;
     }
@@ -342,7 +448,7 @@ private:
         auto result = ParseNotTest();
         while (lexer_.CurrentToken().Is<TokenType::And>()) {
             lexer_.NextToken();
-            result = make_unique<ast::And>(std::move(result), ParseNotTest());
+            result = MakeBinary<ast::And>(std::move(result), ParseNotTest());
         }
         return result;
     }
@@ -351,7 +457,7 @@ private:
     {
         if (lexer_.CurrentToken().Is<TokenType::Not>()) {
             lexer_.NextToken();
-            return make_unique<ast::Not>(ParseNotTest());  // NOLINT
+            return MakeNot(ParseNotTest());  // NOLINT
         }
         return ParseComparison();
     }
@@ -365,33 +471,33 @@ private:
 
         if (tok == '<') {
             lexer_.NextToken();
-            return make_unique<ast::Comparison>(runtime::Less, std::move(result),
-                                                ParseExpression());
+            return make_unique<ast::StaticComparison<ast::detail::LessOp>>(
+                std::move(result), ParseExpression());
         }
         if (tok == '>') {
             lexer_.NextToken();
-            return make_unique<ast::Comparison>(runtime::Greater, std::move(result),
-                                                ParseExpression());
+            return make_unique<ast::StaticComparison<ast::detail::GreaterOp>>(
+                std::move(result), ParseExpression());
         }
         if (tok.Is<TokenType::Eq>()) {
             lexer_.NextToken();
-            return make_unique<ast::Comparison>(runtime::Equal, std::move(result),
-                                                ParseExpression());
+            return make_unique<ast::StaticComparison<ast::detail::EqualOp>>(
+                std::move(result), ParseExpression());
         }
         if (tok.Is<TokenType::NotEq>()) {
             lexer_.NextToken();
-            return make_unique<ast::Comparison>(runtime::NotEqual, std::move(result),
-                                                ParseExpression());
+            return make_unique<ast::StaticComparison<ast::detail::NotEqualOp>>(
+                std::move(result), ParseExpression());
         }
         if (tok.Is<TokenType::LessOrEq>()) {
             lexer_.NextToken();
-            return make_unique<ast::Comparison>(runtime::LessOrEqual, std::move(result),
-                                                ParseExpression());
+            return make_unique<ast::StaticComparison<ast::detail::LessOrEqualOp>>(
+                std::move(result), ParseExpression());
         }
         if (tok.Is<TokenType::GreaterOrEq>()) {
             lexer_.NextToken();
-            return make_unique<ast::Comparison>(runtime::GreaterOrEqual, std::move(result),
-                                                ParseExpression());
+            return make_unique<ast::StaticComparison<ast::detail::GreaterOrEqualOp>>(
+                std::move(result), ParseExpression());
         }
         return result;
     }
@@ -400,6 +506,15 @@ private:
     //           | class ClassDefinition
     //           | if Condition
     unique_ptr<ast::Statement> ParseStatement()  // NOLINT
+    {
+        // привязываем инструкцию к строке её первого токена
+        int line = lexer_.CurrentLine();
+        auto result = ParseStatementKinds();
+        result->SetSourceLine(line);
+        return result;
+    }
+
+    unique_ptr<ast::Statement> ParseStatementKinds()  // NOLINT
     {
         const auto& tok = lexer_.CurrentToken();
 
@@ -410,6 +525,9 @@ private:
         if (tok.Is<TokenType::If>()) {
             return ParseCondition();
         }
+        if (tok.Is<TokenType::While>()) {
+            return ParseWhile();
+        }
         auto result = ParseSimpleStatement();
         lexer_.Expect<TokenType::Newline>();
         lexer_.NextToken();
@@ -445,4 +563,26 @@ private:
 
 unique_ptr<runtime::Executable> ParseProgram(parse::Lexer& lexer) {
     return Parser{lexer}.ParseProgram();
-}
\ No newline at end of file
+}
+
+unique_ptr<runtime::Executable> ParseProgram(parse::Lexer& lexer, runtime::Arena& arena) {
+    runtime::Arena::Scope scope(arena);
+    return Parser{lexer}.ParseProgram();
+}
+
+CompiledProgram::CompiledProgram(parse::Lexer& lexer) :
+    root_(ParseProgram(lexer, arena_)) {
+}
+
+CompiledProgram::~CompiledProgram() {
+    // дерево разрушается раньше арены, в которой размещены его узлы
+    root_.reset();
+}
+
+void CompiledProgram::Run(runtime::Closure& closure, runtime::Context& context) const {
+    root_->Execute(closure, context);
+}
+
+void CompiledProgram::DumpProfile(std::ostream& os) const {
+    runtime::DumpProfile(os);
+}
@@ -1,5 +1,8 @@
 #pragma once
 
+#include "arena.h"
+
+#include <iosfwd>
 #include <memory>
 #include <stdexcept>
 
@@ -8,11 +11,51 @@ class Lexer;
 }
 
 namespace runtime {
+class Closure;
+class Context;
 class Executable;
 }
 
 struct ParseError : std::runtime_error {
     using std::runtime_error::runtime_error;
+
+    // ошибка в строке source_line исходного текста Mython
+    ParseError(const std::string& msg, int source_line);
 };
 
-std::unique_ptr<runtime::Executable> ParseProgram(parse::Lexer& lexer);
\ No newline at end of file
+std::unique_ptr<runtime::Executable> ParseProgram(parse::Lexer& lexer);
+
+// Разбирает программу, размещая узлы AST в арене arena.
+// Арена должна жить дольше возвращённого дерева программы
+std::unique_ptr<runtime::Executable> ParseProgram(parse::Lexer& lexer, runtime::Arena& arena);
+
+/*
+ * Программа, разобранная один раз и пригодная для многократного выполнения.
+ * Дерево программы после разбора неизменно: узлы не хранят состояния
+ * запуска, поэтому один CompiledProgram можно выполнять одновременно
+ * из нескольких потоков - каждый запуск получает собственные Closure
+ * и Context
+ */
+class CompiledProgram {
+public:
+    // Разбирает программу из lexer; узлы дерева размещаются
+    // в собственной арене программы
+    explicit CompiledProgram(parse::Lexer& lexer);
+
+    CompiledProgram(const CompiledProgram&) = delete;
+    CompiledProgram& operator=(const CompiledProgram&) = delete;
+
+    ~CompiledProgram();
+
+    // Выполняет программу в замыкании closure с контекстом context
+    void Run(runtime::Closure& closure, runtime::Context& context) const;
+
+    // Выводит в os профиль выполнения по строкам и методам.
+    // Работает только в сборке с -DMYTHON_PROFILE (make PROFILE=1),
+    // иначе не выводит ничего
+    void DumpProfile(std::ostream& os) const;
+
+private:
+    runtime::Arena arena_;                      // арена узлов дерева
+    std::unique_ptr<runtime::Executable> root_; // корень дерева программы
+};
\ No newline at end of file
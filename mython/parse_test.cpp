@@ -1,3 +1,4 @@
+#include "arena.h"
 #include "lexer.h"
 #include "parse.h"
 #include "statement.h"
@@ -244,6 +245,140 @@ print r, c, t1, t2
                  "Rect(10x20) Circle(52) Triangle(3, 4, 5) Wrong triangle\n"s);
 }
 
+void TestProgramInArena() {
+    const string program = R"(
+x = 2
+y = x + 3
+print x * y
+)";
+
+    runtime::Arena arena;
+    istringstream is(program);
+    parse::Lexer lexer(is);
+    auto tree = ParseProgram(lexer, arena);
+    // узлы программы размещены в арене
+    ASSERT(arena.BytesReserved() > 0);
+
+    runtime::DummyContext context;
+    runtime::Closure closure;
+    tree->Execute(closure, context);
+    ASSERT_EQUAL(context.output.str(), "10\n"s);
+
+    // узлы должны разрушаться раньше арены
+    tree.reset();
+}
+
+void TestConstantFolding() {
+    // константные выражения сворачиваются при разборе,
+    // результат выполнения при этом не меняется
+    istringstream input(R"(
+x = 2 * 5 + 10 / 2
+if not False and x > 0:
+  print x, 'ab' + 'c'
+else:
+  print 'dead branch'
+)"s);
+
+    parse::Lexer lexer(input);
+    auto tree = ParseProgram(lexer);
+
+    runtime::DummyContext context;
+
+    runtime::Closure closure;
+    tree->Execute(closure, context);
+
+    ASSERT_EQUAL(context.output.str(), "15 abc\n"s);
+}
+
+void TestExecutionSessionRun() {
+    // программа с перепривязкой переменной: заимствованные значения
+    // не должны переживать свою инструкцию (регресс сессионного режима)
+    istringstream input(R"(
+a = 'he'
+b = 'llo'
+x = a + b
+y = x
+x = 0
+print y
+while x < 3:
+  x = x + 1
+print x, y
+)"s);
+
+    parse::Lexer lexer(input);
+    CompiledProgram program(lexer);
+
+    runtime::DummyContext context;
+    runtime::Closure closure;
+
+    runtime::ExecutionSession session;
+    program.Run(closure, context);
+
+    ASSERT_EQUAL(context.output.str(), "hello\n3 hello\n"s);
+}
+
+void TestCompiledProgramReuse() {
+    istringstream input(R"(
+class Counter:
+  def __init__():
+    self.value = 0
+
+  def add():
+    self.value = self.value + 1
+
+class Maker:
+  def make():
+    return Counter()
+
+m = Maker()
+a = m.make()
+b = m.make()
+a.add()
+a.add()
+b.add()
+print a.value, b.value
+)"s);
+
+    parse::Lexer lexer(input);
+    CompiledProgram program(lexer);
+
+    // каждое выполнение NewInstance создаёт собственный экземпляр,
+    // а повторные запуски программы не разделяют состояния
+    for (int i = 0; i < 2; ++i) {
+        runtime::DummyContext context;
+        runtime::Closure closure;
+        program.Run(closure, context);
+        ASSERT_EQUAL(context.output.str(), "2 1\n"s);
+    }
+}
+
+void TestWhile() {
+    // счётчик крутится плоским циклом - итераций заведомо больше,
+    // чем выдержала бы рекурсия
+    istringstream input(R"(
+i = 0
+evens = 0
+while i < 100000:
+  i = i + 1
+  if i < 6:
+    evens = evens + i
+print i, evens
+
+while False:
+  print 'never'
+)"s);
+
+    parse::Lexer lexer(input);
+    auto tree = ParseProgram(lexer);
+
+    runtime::DummyContext context;
+
+    runtime::Closure closure;
+    tree->Execute(closure, context);
+
+    ASSERT_EQUAL(context.output.str(), "100000 15\n"s);
+}
+
 }  // namespace parse
 
 void TestParseProgram(TestRunner& tr) {
@@ -255,4 +390,9 @@ void TestParseProgram(TestRunner& tr) {
     RUN_TEST(tr, parse::TestRecursion2);
     RUN_TEST(tr, parse::TestComplexLogicalExpression);
     RUN_TEST(tr, parse::TestClassicalPolymorphism);
+    RUN_TEST(tr, parse::TestProgramInArena);
+    RUN_TEST(tr, parse::TestConstantFolding);
+    RUN_TEST(tr, parse::TestExecutionSessionRun);
+    RUN_TEST(tr, parse::TestCompiledProgramReuse);
+    RUN_TEST(tr, parse::TestWhile);
 }
\ No newline at end of file
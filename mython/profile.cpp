@@ -0,0 +1,121 @@
+#include "profile.h"
+
+#include <ostream>
+
+#ifdef MYTHON_PROFILE
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#endif
+
+using namespace std;
+
+namespace runtime {
+
+#ifdef MYTHON_PROFILE
+
+namespace {
+
+// счётчики одной точки замера
+struct ProfileRecord {
+    uint64_t calls = 0;
+    uint64_t nanos = 0;
+};
+
+// реестр замеров; защищён мьютексом - программа может
+// выполняться из нескольких потоков
+struct ProfileRegistry {
+    mutex guard;
+    map<int, ProfileRecord> lines;
+    unordered_map<string, ProfileRecord> methods;
+};
+
+ProfileRegistry& GetRegistry() {
+    static ProfileRegistry registry;
+    return registry;
+}
+
+uint64_t Now() {
+    return static_cast<uint64_t>(
+        chrono::steady_clock::now().time_since_epoch().count());
+}
+
+}  // namespace
+
+void Profiler::RecordLine(int line, uint64_t nanos) {
+    ProfileRegistry& registry = GetRegistry();
+    lock_guard<mutex> lock(registry.guard);
+    ProfileRecord& record = registry.lines[line];
+    ++record.calls;
+    record.nanos += nanos;
+}
+
+void Profiler::RecordMethod(const string& name, uint64_t nanos) {
+    ProfileRegistry& registry = GetRegistry();
+    lock_guard<mutex> lock(registry.guard);
+    ProfileRecord& record = registry.methods[name];
+    ++record.calls;
+    record.nanos += nanos;
+}
+
+void Profiler::Dump(ostream& os) {
+    ProfileRegistry& registry = GetRegistry();
+    lock_guard<mutex> lock(registry.guard);
+
+    os << "== profile: lines ==\n";
+    for (const auto& [line, record] : registry.lines) {
+        os << "line " << line << ": " << record.calls << " calls, "
+           << record.nanos << " ns\n";
+    }
+
+    os << "== profile: methods ==\n";
+    vector<pair<string, ProfileRecord>> methods(registry.methods.begin(),
+                                                registry.methods.end());
+    sort(methods.begin(), methods.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.second.nanos > rhs.second.nanos;
+    });
+    for (const auto& [name, record] : methods) {
+        os << name << ": " << record.calls << " calls, "
+           << record.nanos << " ns\n";
+    }
+}
+
+void Profiler::Reset() {
+    ProfileRegistry& registry = GetRegistry();
+    lock_guard<mutex> lock(registry.guard);
+    registry.lines.clear();
+    registry.methods.clear();
+}
+
+LineProfileScope::LineProfileScope(int line) : line_(line),
+                                               start_(Now()) {
+}
+
+LineProfileScope::~LineProfileScope() {
+    Profiler::RecordLine(line_, Now() - start_);
+}
+
+MethodProfileScope::MethodProfileScope(const string& cls, const string& method) :
+    name_(cls + "." + method),
+    start_(Now()) {
+}
+
+MethodProfileScope::~MethodProfileScope() {
+    Profiler::RecordMethod(name_, Now() - start_);
+}
+
+void DumpProfile(ostream& os) {
+    Profiler::Dump(os);
+}
+
+#else
+
+void DumpProfile(ostream& /*os*/) {
+}
+
+#endif  // MYTHON_PROFILE
+
+}  // namespace runtime
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+/*
+ * Опциональная инструментация интерпретатора: счётчики вызовов и
+ * суммарное время по строкам исходного текста и по методам Mython.
+ * Включается сборкой с -DMYTHON_PROFILE (make PROFILE=1); без флага
+ * профилировочные области компилируются в пустые объявления и кода
+ * не генерируют - накладные расходы строго нулевые
+ */
+namespace runtime {
+
+#ifdef MYTHON_PROFILE
+
+// Глобальный реестр замеров
+class Profiler {
+public:
+    // Учитывает один запуск инструкции на строке line длительностью nanos
+    static void RecordLine(int line, uint64_t nanos);
+    // Учитывает один вызов метода name (вида "Класс.метод") длительностью nanos
+    static void RecordMethod(const std::string& name, uint64_t nanos);
+    // Выводит в os отчёт по строкам и методам, отсортированный по времени
+    static void Dump(std::ostream& os);
+    // Сбрасывает накопленные замеры
+    static void Reset();
+};
+
+// RAII-замер выполнения инструкции на строке line
+class LineProfileScope {
+public:
+    explicit LineProfileScope(int line);
+    ~LineProfileScope();
+
+    LineProfileScope(const LineProfileScope&) = delete;
+    LineProfileScope& operator=(const LineProfileScope&) = delete;
+
+private:
+    int line_;
+    uint64_t start_;
+};
+
+// RAII-замер вызова метода method класса cls
+class MethodProfileScope {
+public:
+    MethodProfileScope(const std::string& cls, const std::string& method);
+    ~MethodProfileScope();
+
+    MethodProfileScope(const MethodProfileScope&) = delete;
+    MethodProfileScope& operator=(const MethodProfileScope&) = delete;
+
+private:
+    std::string name_;
+    uint64_t start_;
+};
+
+#define MYTHON_PROFILE_LINE(line) runtime::LineProfileScope mython_profile_scope{line}
+#define MYTHON_PROFILE_METHOD(cls, method) runtime::MethodProfileScope mython_profile_scope{cls, method}
+
+#else
+
+#define MYTHON_PROFILE_LINE(line) static_cast<void>(0)
+#define MYTHON_PROFILE_METHOD(cls, method) static_cast<void>(0)
+
+#endif  // MYTHON_PROFILE
+
+// Выводит в os накопленный профиль выполнения.
+// В сборке без MYTHON_PROFILE не выводит ничего
+void DumpProfile(std::ostream& os);
+
+}  // namespace runtime
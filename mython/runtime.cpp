@@ -1,5 +1,8 @@
 #include "runtime.h"
 
+#include "arena.h"
+#include "profile.h"
+
 #include <cassert>
 #include <optional>
 #include <sstream>
@@ -10,15 +13,114 @@ namespace runtime {
 
 ObjectHolder::ObjectHolder(std::shared_ptr<Object> data)
     : data_(std::move(data)) {
+    repr_ = (data_ != nullptr) ? Repr::Shared : Repr::Empty;
+}
+
+ObjectHolder::ObjectHolder(const ObjectHolder& other)
+    : data_(other.data_),
+      repr_(other.repr_) {
+    if ((repr_ == Repr::InlineNumber) || (repr_ == Repr::InlineBool)) {
+        CopyInline(other);
+    }
+}
+
+ObjectHolder::ObjectHolder(ObjectHolder&& other) noexcept
+    : data_(std::move(other.data_)),
+      repr_(other.repr_) {
+    if ((repr_ == Repr::InlineNumber) || (repr_ == Repr::InlineBool)) {
+        CopyInline(other);
+        other.DestroyInline();
+    }
+    other.repr_ = Repr::Empty;
+}
+
+ObjectHolder& ObjectHolder::operator=(const ObjectHolder& other) {
+    if (this != &other) {
+        DestroyInline();
+        data_ = other.data_;
+        repr_ = other.repr_;
+        if ((repr_ == Repr::InlineNumber) || (repr_ == Repr::InlineBool)) {
+            CopyInline(other);
+        }
+    }
+    return *this;
+}
+
+ObjectHolder& ObjectHolder::operator=(ObjectHolder&& other) noexcept {
+    if (this != &other) {
+        DestroyInline();
+        data_ = std::move(other.data_);
+        repr_ = other.repr_;
+        if ((repr_ == Repr::InlineNumber) || (repr_ == Repr::InlineBool)) {
+            CopyInline(other);
+            other.DestroyInline();
+        }
+        other.repr_ = Repr::Empty;
+    }
+    return *this;
+}
+
+ObjectHolder::~ObjectHolder() {
+    DestroyInline();
+}
+
+void ObjectHolder::CopyInline(const ObjectHolder& other) {
+    if (other.repr_ == Repr::InlineNumber) {
+        new (inline_storage_) Number(*std::launder(
+            reinterpret_cast<const Number*>(other.inline_storage_)));
+    }
+    else {
+        new (inline_storage_) Bool(*std::launder(
+            reinterpret_cast<const Bool*>(other.inline_storage_)));
+    }
+}
+
+void ObjectHolder::DestroyInline() {
+    if (repr_ == Repr::InlineNumber) {
+        std::launder(reinterpret_cast<Number*>(inline_storage_))->~ValueObject<int>();
+    }
+    else if (repr_ == Repr::InlineBool) {
+        std::launder(reinterpret_cast<Bool*>(inline_storage_))->~Bool();
+    }
+}
+
+ObjectHolder ObjectHolder::Own(Number object) {
+    ObjectHolder result;
+    new (result.inline_storage_) Number(std::move(object));
+    result.repr_ = Repr::InlineNumber;
+    return result;
+}
+
+ObjectHolder ObjectHolder::Own(Bool object) {
+    ObjectHolder result;
+    new (result.inline_storage_) Bool(std::move(object));
+    result.repr_ = Repr::InlineBool;
+    return result;
 }
 
 void ObjectHolder::AssertIsValid() const {
-    assert(data_ != nullptr);
+    assert(repr_ != Repr::Empty);
 }
 
+namespace {
+
+// deleter невладеющего холдера; именованный тип позволяет отличить
+// Share-холдер через get_deleter
+struct NonOwningDeleter {
+    void operator()(Object* /*p*/) const { /* do nothing */ }
+};
+
+}  // namespace
+
 ObjectHolder ObjectHolder::Share(Object& object) {
     // Возвращаем невладеющий shared_ptr (его deleter ничего не делает)
-    return ObjectHolder(std::shared_ptr<Object>(&object, [](auto* /*p*/) { /* do nothing */ }));
+    return ObjectHolder(std::shared_ptr<Object>(&object, NonOwningDeleter{}));
+}
+
+ObjectHolder ObjectHolder::Borrow(Object& object) {
+    // шаблонный конструктор совмещения с пустым владельцем: у такого
+    // shared_ptr нет блока владения, копии не делают атомарных операций
+    return ObjectHolder(std::shared_ptr<Object>(std::shared_ptr<Object>(), &object));
 }
 
 ObjectHolder ObjectHolder::None() {
@@ -36,36 +138,103 @@ Object* ObjectHolder::operator->() const {
 }
 
 Object* ObjectHolder::Get() const {
-    return data_.get();
+    switch (repr_) {
+    case Repr::InlineNumber:
+        return std::launder(
+            reinterpret_cast<Number*>(const_cast<unsigned char*>(inline_storage_)));
+    case Repr::InlineBool:
+        return std::launder(
+            reinterpret_cast<Bool*>(const_cast<unsigned char*>(inline_storage_)));
+    case Repr::Shared:
+        return data_.get();
+    default:
+        return nullptr;
+    }
 }
 
 ObjectHolder::operator bool() const {
-    return Get() != nullptr;
+    return repr_ != Repr::Empty;
 }
 
-bool IsTrue(const ObjectHolder& object) {
-    if (object) {
-        if ((object.TryAs<Bool>() != nullptr) &&
-             object.TryAs<Bool>()->GetValue()) {
-            return true;
-        }
-        if ((object.TryAs<Number>() != nullptr) &&
-            (object.TryAs<Number>()->GetValue() != 0)) {
-            return true;
-        }
-        if ((object.TryAs<String>() != nullptr) &&
-            !object.TryAs<String>()->GetValue().empty()) {
-            return true;
-        }
+namespace {
+
+// глубина вложенных сессий текущего потока
+thread_local int session_depth = 0;
+
+}  // namespace
+
+ExecutionSession::ExecutionSession() {
+    ++session_depth;
+}
+
+ExecutionSession::~ExecutionSession() {
+    --session_depth;
+}
+
+bool ExecutionSession::IsActive() {
+    return session_depth > 0;
+}
+
+bool ObjectHolder::IsUniquelyOwned() const {
+    return (repr_ == Repr::Shared)
+        && (data_.use_count() == 1)
+        && (std::get_deleter<NonOwningDeleter>(data_) == nullptr);
+}
+
+namespace {
+
+// служебный заголовок перед каждым узлом AST:
+// ненулевое значение - память выделена в арене
+constexpr size_t NODE_HEADER_SIZE = alignof(max_align_t);
+
+}  // namespace
+
+void* Executable::operator new(std::size_t size) {
+    void* memory = nullptr;
+    size_t arena_mark = 0;
+    if (Arena* arena = Arena::Active()) {
+        memory = arena->Allocate(size + NODE_HEADER_SIZE, alignof(max_align_t));
+        arena_mark = 1;
+    }
+    else {
+        memory = ::operator new(size + NODE_HEADER_SIZE);
     }
+    *static_cast<size_t*>(memory) = arena_mark;
+    return static_cast<unsigned char*>(memory) + NODE_HEADER_SIZE;
+}
 
-    return false;
+void Executable::operator delete(void* ptr) noexcept {
+    if (nullptr == ptr) {
+        return;
+    }
+    unsigned char* memory = static_cast<unsigned char*>(ptr) - NODE_HEADER_SIZE;
+    if (0 == *reinterpret_cast<size_t*>(memory)) {
+        ::operator delete(memory);
+    }
+}
+
+bool IsTrue(const ObjectHolder& object) {
+    const Object* obj = object.Get();
+    if (nullptr == obj) {
+        return false;
+    }
+    switch (obj->GetType()) {
+    case ObjectType::Bool:
+        return static_cast<const Bool*>(obj)->GetValue();
+    case ObjectType::Number:
+        return static_cast<const Number*>(obj)->GetValue() != 0;
+    case ObjectType::String:
+        return !static_cast<const String*>(obj)->GetValue().empty();
+    default:
+        return false;
+    }
 }
 
 void ClassInstance::Print(std::ostream& os, Context& context) {
-    if (HasMethod("__str__"s, 0)) {
+    static const Symbol str_symbol = Intern("__str__"s);
+    if (HasMethod(str_symbol, 0)) {
         // если есть специальный метод - вызываем его
-        Call("__str__"s, {}, context)->Print(os, context);
+        Call(str_symbol, {}, context)->Print(os, context);
     }
     else {
         // печать адреса
@@ -74,6 +243,10 @@ void ClassInstance::Print(std::ostream& os, Context& context) {
 }
 
 bool ClassInstance::HasMethod(const std::string& method, size_t argument_count) const {
+    return HasMethod(Intern(method), argument_count);
+}
+
+bool ClassInstance::HasMethod(Symbol method, size_t argument_count) const {
     const Method* p_method = class_.GetMethod(method);
     if (nullptr != p_method) {
         if (argument_count == p_method->formal_params.size()) {
@@ -91,50 +264,128 @@ const Closure& ClassInstance::Fields() const {
     return fields_;
 }
 
-ClassInstance::ClassInstance(const Class& cls) : class_(cls) {
+ClassInstance::ClassInstance(const Class& cls) : Object(ObjectType::ClassInstance),
+                                                 class_(cls) {
 }
 
 ObjectHolder ClassInstance::Call(const std::string& method,
                                  const std::vector<ObjectHolder>& actual_args,
                                  Context& context) {
-    if (HasMethod(method, actual_args.size())) {
-        Closure closure;
-        closure["self"s] = ObjectHolder::Share(*this);
-        const Method* p_method = class_.GetMethod(method);
-        size_t param_size = p_method->formal_params.size();
-        for (size_t i = 0; i < param_size; ++i) {
-            closure[p_method->formal_params[i]] = actual_args[i];
+    return Call(Intern(method), actual_args, context);
+}
+
+ObjectHolder ClassInstance::Call(Symbol method,
+                                 const std::vector<ObjectHolder>& actual_args,
+                                 Context& context) {
+    // один поиск в таблице функций вместо пары HasMethod/GetMethod
+    const Method* p_method = class_.GetMethod(method);
+    if ((nullptr != p_method) && (actual_args.size() == p_method->formal_params.size())) {
+        return CallMethod(p_method, actual_args, context);
+    }
+    throw std::runtime_error("Call for an undefined method \"" + SymbolName(method) + "\"");
+}
+
+namespace {
+
+// Пул кадров вызова: Closure с его хеш-таблицей дорого создавать и
+// уничтожать на каждый вызов метода, поэтому отработавшие кадры не
+// освобождаются, а возвращаются в пул. clear() сохраняет корзины
+// хеш-таблицы, так что повторное связывание параметров обходится
+// без новых выделений памяти
+thread_local std::vector<std::unique_ptr<Closure>> frame_pool;
+
+// RAII-владение кадром из пула на время одного вызова
+class PooledFrame {
+public:
+    PooledFrame() {
+        if (!frame_pool.empty()) {
+            frame_ = std::move(frame_pool.back());
+            frame_pool.pop_back();
+        }
+        else {
+            frame_ = std::make_unique<Closure>();
         }
-        return p_method->body.get()->Execute(closure, context);
     }
-    else {
-        throw std::runtime_error("Call for an undefined method \"" + method + "\"");
+
+    ~PooledFrame() {
+        frame_->clear();
+        frame_pool.push_back(std::move(frame_));
     }
+
+    PooledFrame(const PooledFrame&) = delete;
+    PooledFrame& operator=(const PooledFrame&) = delete;
+
+    Closure& Get() {
+        return *frame_;
+    }
+
+private:
+    std::unique_ptr<Closure> frame_;
+};
+
+}  // namespace
+
+ObjectHolder ClassInstance::CallMethod(const Method* method,
+                                       const std::vector<ObjectHolder>& actual_args,
+                                       Context& context) {
+    MYTHON_PROFILE_METHOD(class_.GetName(), method->name);
+    static const Symbol self_symbol = Intern("self"s);
+    PooledFrame frame;
+    Closure& closure = frame.Get();
+    size_t param_size = method->formal_param_symbols.size();
+    closure.reserve(1 + param_size);
+    closure[self_symbol] = ObjectHolder::Share(*this);
+    for (size_t i = 0; i < param_size; ++i) {
+        closure[method->formal_param_symbols[i]] = actual_args[i];
+    }
+    return method->body.get()->Execute(closure, context);
 }
 
 Class::Class(std::string name,
              std::vector<Method> methods,
-             const Class* parent) : name_(name),
+             const Class* parent) : Object(ObjectType::Class),
+                                    name_(name),
                                     methods_(move(methods)),
                                     parent_(parent) {
-    if (nullptr != parent_) {
-        for (const auto& method : parent_->methods_) {
-            // заполняем таблицу функций методами родителя
-            v_table_[method.name] = &method;
+    for (auto& method : methods_) {
+        // интернируем имена формальных параметров один раз при создании класса
+        method.formal_param_symbols.clear();
+        method.formal_param_symbols.reserve(method.formal_params.size());
+        for (const auto& param : method.formal_params) {
+            method.formal_param_symbols.push_back(Intern(param));
         }
     }
+    if (nullptr != parent_) {
+        // копируем раскладку родителя: унаследованные методы остаются
+        // в своих слотах, переопределения замещают их по месту
+        method_slots_ = parent_->method_slots_;
+        v_table_ = parent_->v_table_;
+    }
     for (const auto& method : methods_) {
         // заполняем таблицу функций своими методами
-        v_table_[method.name] = &method;
+        Symbol name_symbol = Intern(method.name);
+        auto [it, inserted] = method_slots_.emplace(name_symbol,
+                                                    static_cast<uint32_t>(v_table_.size()));
+        if (inserted) {
+            v_table_.push_back(&method);
+        }
+        else {
+            v_table_[it->second] = &method;
+        }
     }
 }
 
 const Method* Class::GetMethod(const std::string& name) const {
-    if (v_table_.count(name) != 0) {
-        // т.к. используем мапу то берем метод за О(1)
-        return v_table_.at(name);
+    return GetMethod(Intern(name));
+}
+
+const Method* Class::GetMethod(Symbol name) const {
+    // один поиск слота по имени и обращение к вектору по индексу
+    auto it = method_slots_.find(name);
+    if (it == method_slots_.end()) {
+        return nullptr;
     }
-    return nullptr;
+    return v_table_[it->second];
 }
 
 [[nodiscard]] const std::string& Class::GetName() const {
@@ -155,62 +406,92 @@ bool Equal(const ObjectHolder& lhs, const ObjectHolder& rhs, Context& context) {
         return true;
     }
 
-    auto c_obj_lhs = lhs.TryAs<ClassInstance>();
-    if (nullptr != c_obj_lhs) {
-        if (c_obj_lhs->HasMethod("__eq__"s, 1)) {
-            ObjectHolder obj;
-            obj = c_obj_lhs->Call("__eq__"s, {rhs}, context);
-            return obj.TryAs<Bool>()->GetValue();
+    // один switch по тегу типа вместо последовательных dynamic_cast
+    Object* lhs_obj = lhs.Get();
+    Object* rhs_obj = rhs.Get();
+    if (nullptr != lhs_obj) {
+        switch (lhs_obj->GetType()) {
+        case ObjectType::ClassInstance: {
+            auto* c_obj_lhs = static_cast<ClassInstance*>(lhs_obj);
+            static const Symbol eq_symbol = Intern("__eq__"s);
+            if (c_obj_lhs->HasMethod(eq_symbol, 1)) {
+                ObjectHolder obj;
+                obj = c_obj_lhs->Call(eq_symbol, {rhs}, context);
+                return obj.TryAs<Bool>()->GetValue();
+            }
+            static const Symbol cmp_symbol = Intern("__cmp__"s);
+            if (c_obj_lhs->HasMethod(cmp_symbol, 1)) {
+                return Compare(lhs, rhs, context) == Ordering::Equal;
+            }
+            break;
+        }
+        case ObjectType::Bool:
+            if ((nullptr != rhs_obj) && (rhs_obj->GetType() == ObjectType::Bool)) {
+                return static_cast<Bool*>(lhs_obj)->GetValue() ==
+                       static_cast<Bool*>(rhs_obj)->GetValue();
+            }
+            break;
+        case ObjectType::Number:
+            if ((nullptr != rhs_obj) && (rhs_obj->GetType() == ObjectType::Number)) {
+                return static_cast<Number*>(lhs_obj)->GetValue() ==
+                       static_cast<Number*>(rhs_obj)->GetValue();
+            }
+            break;
+        case ObjectType::String:
+            if ((nullptr != rhs_obj) && (rhs_obj->GetType() == ObjectType::String)) {
+                return static_cast<String*>(lhs_obj)->GetValue() ==
+                       static_cast<String*>(rhs_obj)->GetValue();
+            }
+            break;
+        default:
+            break;
         }
-    }
-
-    auto b_obj_lhs = lhs.TryAs<Bool>();
-    auto b_obj_rhs = rhs.TryAs<Bool>();
-    if ((nullptr != b_obj_lhs) && (nullptr != b_obj_rhs)) {
-        return b_obj_lhs->GetValue() == b_obj_rhs->GetValue();
-    }
-
-    auto n_obj_lhs = lhs.TryAs<Number>();
-    auto n_obj_rhs = rhs.TryAs<Number>();
-    if ((nullptr != n_obj_lhs) && (nullptr != n_obj_rhs)) {
-        return n_obj_lhs->GetValue() == n_obj_rhs->GetValue();
-    }
-
-    auto s_obj_lhs = lhs.TryAs<String>();
-    auto s_obj_rhs = rhs.TryAs<String>();
-    if ((nullptr != s_obj_lhs) && (nullptr != s_obj_rhs)) {
-        return s_obj_lhs->GetValue() == s_obj_rhs->GetValue();
     }
 
     throw std::runtime_error("Cannot compare objects for equality"s);
 }
 
 bool Less(const ObjectHolder& lhs, const ObjectHolder& rhs, Context& context) {
-    auto c_obj_lhs = lhs.TryAs<ClassInstance>();
-    if (nullptr != c_obj_lhs) {
-        if (c_obj_lhs->HasMethod("__lt__"s, 1)) {
-            ObjectHolder obj;
-            obj = c_obj_lhs->Call("__lt__"s, {rhs}, context);
-            return obj.TryAs<Bool>()->GetValue();
+    // один switch по тегу типа вместо последовательных dynamic_cast
+    Object* lhs_obj = lhs.Get();
+    Object* rhs_obj = rhs.Get();
+    if (nullptr != lhs_obj) {
+        switch (lhs_obj->GetType()) {
+        case ObjectType::ClassInstance: {
+            auto* c_obj_lhs = static_cast<ClassInstance*>(lhs_obj);
+            static const Symbol lt_symbol = Intern("__lt__"s);
+            if (c_obj_lhs->HasMethod(lt_symbol, 1)) {
+                ObjectHolder obj;
+                obj = c_obj_lhs->Call(lt_symbol, {rhs}, context);
+                return obj.TryAs<Bool>()->GetValue();
+            }
+            static const Symbol cmp_symbol = Intern("__cmp__"s);
+            if (c_obj_lhs->HasMethod(cmp_symbol, 1)) {
+                return Compare(lhs, rhs, context) == Ordering::Less;
+            }
+            break;
+        }
+        case ObjectType::Bool:
+            if ((nullptr != rhs_obj) && (rhs_obj->GetType() == ObjectType::Bool)) {
+                return static_cast<Bool*>(lhs_obj)->GetValue() <
+                       static_cast<Bool*>(rhs_obj)->GetValue();
+            }
+            break;
+        case ObjectType::Number:
+            if ((nullptr != rhs_obj) && (rhs_obj->GetType() == ObjectType::Number)) {
+                return static_cast<Number*>(lhs_obj)->GetValue() <
+                       static_cast<Number*>(rhs_obj)->GetValue();
+            }
+            break;
+        case ObjectType::String:
+            if ((nullptr != rhs_obj) && (rhs_obj->GetType() == ObjectType::String)) {
+                return static_cast<String*>(lhs_obj)->GetValue() <
+                       static_cast<String*>(rhs_obj)->GetValue();
+            }
+            break;
+        default:
+            break;
         }
-    }
-
-    auto b_obj_lhs = lhs.TryAs<Bool>();
-    auto b_obj_rhs = rhs.TryAs<Bool>();
-    if ((nullptr != b_obj_lhs) && (nullptr != b_obj_rhs)) {
-        return b_obj_lhs->GetValue() < b_obj_rhs->GetValue();
-    }
-
-    auto n_obj_lhs = lhs.TryAs<Number>();
-    auto n_obj_rhs = rhs.TryAs<Number>();
-    if ((nullptr != n_obj_lhs) && (nullptr != n_obj_rhs)) {
-        return n_obj_lhs->GetValue() < n_obj_rhs->GetValue();
-    }
-
-    auto s_obj_lhs = lhs.TryAs<String>();
-    auto s_obj_rhs = rhs.TryAs<String>();
-    if ((nullptr != s_obj_lhs) && (nullptr != s_obj_rhs)) {
-        return s_obj_lhs->GetValue() < s_obj_rhs->GetValue();
     }
 
     throw std::runtime_error("Cannot compare objects for less"s);
@@ -221,15 +502,93 @@ bool NotEqual(const ObjectHolder& lhs, const ObjectHolder& rhs, Context& context
 }
 
 bool Greater(const ObjectHolder& lhs, const ObjectHolder& rhs, Context& context) {
-    return !(Less(lhs, rhs, context) || Equal(lhs, rhs, context));
+    // один разбор типов вместо пары Less/Equal
+    return Compare(lhs, rhs, context) == Ordering::Greater;
 }
 
 bool LessOrEqual(const ObjectHolder& lhs, const ObjectHolder& rhs, Context& context) {
-    return (Less(lhs, rhs, context) || Equal(lhs, rhs, context));
+    // один разбор типов вместо пары Less/Equal
+    return Compare(lhs, rhs, context) != Ordering::Greater;
 }
 
 bool GreaterOrEqual(const ObjectHolder& lhs, const ObjectHolder& rhs, Context& context) {
     return !Less(lhs, rhs, context);
 }
 
+namespace {
+
+// порядок двух значений, сравнимых оператором <
+template <typename T>
+Ordering OrderingOf(const T& lhs, const T& rhs) {
+    if (lhs < rhs) {
+        return Ordering::Less;
+    }
+    if (rhs < lhs) {
+        return Ordering::Greater;
+    }
+    return Ordering::Equal;
+}
+
+}  // namespace
+
+Ordering Compare(const ObjectHolder& lhs, const ObjectHolder& rhs, Context& context) {
+    // None не упорядочен даже с самим собой - равенство None
+    // обрабатывается отдельно в Equal/NotEqual
+
+    // один switch по тегу типа вместо последовательных dynamic_cast
+    Object* lhs_obj = lhs.Get();
+    Object* rhs_obj = rhs.Get();
+    if (nullptr != lhs_obj) {
+        switch (lhs_obj->GetType()) {
+        case ObjectType::ClassInstance: {
+            auto* c_obj_lhs = static_cast<ClassInstance*>(lhs_obj);
+            static const Symbol cmp_symbol = Intern("__cmp__"s);
+            if (c_obj_lhs->HasMethod(cmp_symbol, 1)) {
+                // один вызов метода вместо пары __lt__/__eq__
+                ObjectHolder obj = c_obj_lhs->Call(cmp_symbol, {rhs}, context);
+                const auto* num = obj.TryAs<Number>();
+                if (nullptr == num) {
+                    throw std::runtime_error("__cmp__ must return a number"s);
+                }
+                int result = num->GetValue();
+                if (result < 0) {
+                    return Ordering::Less;
+                }
+                if (result > 0) {
+                    return Ordering::Greater;
+                }
+                return Ordering::Equal;
+            }
+            // без __cmp__ восстанавливаем порядок через __lt__ и __eq__
+            if (Less(lhs, rhs, context)) {
+                return Ordering::Less;
+            }
+            return Equal(lhs, rhs, context) ? Ordering::Equal : Ordering::Greater;
+        }
+        case ObjectType::Bool:
+            if ((nullptr != rhs_obj) && (rhs_obj->GetType() == ObjectType::Bool)) {
+                return OrderingOf(static_cast<Bool*>(lhs_obj)->GetValue(),
+                                  static_cast<Bool*>(rhs_obj)->GetValue());
+            }
+            break;
+        case ObjectType::Number:
+            if ((nullptr != rhs_obj) && (rhs_obj->GetType() == ObjectType::Number)) {
+                return OrderingOf(static_cast<Number*>(lhs_obj)->GetValue(),
+                                  static_cast<Number*>(rhs_obj)->GetValue());
+            }
+            break;
+        case ObjectType::String:
+            if ((nullptr != rhs_obj) && (rhs_obj->GetType() == ObjectType::String)) {
+                return OrderingOf(static_cast<String*>(lhs_obj)->GetValue(),
+                                  static_cast<String*>(rhs_obj)->GetValue());
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    throw std::runtime_error("Cannot compare objects"s);
+}
+
 }  // namespace runtime
\ No newline at end of file
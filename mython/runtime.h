@@ -1,11 +1,23 @@
 #pragma once
 
+#include "shape.h"
+#include "symbol.h"
+
+#include <charconv>
+#include <cstdint>
+#include <initializer_list>
 #include <memory>
+#include <new>
 #include <sstream>
 #include <string>
+#include <type_traits>
 #include <unordered_map>
 #include <vector>
 
+namespace vm {
+class Compiler;
+}  // namespace vm
+
 namespace runtime {
 
 // Контекст исполнения инструкций Mython
@@ -18,30 +30,173 @@ protected:
     ~Context() = default;
 };
 
+// Тег типа объекта. Позволяет определять конкретный тип объекта
+// одним сравнением вместо dynamic_cast
+enum class ObjectType : uint8_t {
+    Other,          // прочие объекты (например, объекты из тестов)
+    Number,         // числовое значение
+    Bool,           // логическое значение
+    String,         // строковое значение
+    Class,          // класс
+    ClassInstance,  // экземпляр класса
+};
+
 // Базовый класс для всех объектов языка Mython
 class Object {
 public:
     virtual ~Object() = default;
     // выводит в os своё представление в виде строки
     virtual void Print(std::ostream& os, Context& context) = 0;
+
+    // Возвращает тег типа объекта
+    [[nodiscard]] ObjectType GetType() const {
+        return type_;
+    }
+
+protected:
+    Object() = default;
+    explicit Object(ObjectType type)
+        : type_(type) {
+    }
+
+private:
+    ObjectType type_ = ObjectType::Other;
 };
 
-// Специальный класс-обёртка, предназначенный для хранения объекта в Mython-программе
+namespace detail {
+// Тег, соответствующий типу T. Для типов без собственного тега
+// остаётся ObjectType::Other - для них TryAs использует dynamic_cast
+template <typename T>
+inline constexpr ObjectType kTypeTag = ObjectType::Other;
+}  // namespace detail
+
+namespace detail {
+// тег для значения типа T, хранящегося в ValueObject
+template <typename T>
+constexpr ObjectType ValueTypeTag() {
+    if constexpr (std::is_same_v<T, int>) {
+        return ObjectType::Number;
+    }
+    else if constexpr (std::is_same_v<T, bool>) {
+        return ObjectType::Bool;
+    }
+    else if constexpr (std::is_same_v<T, std::string>) {
+        return ObjectType::String;
+    }
+    else {
+        return ObjectType::Other;
+    }
+}
+}  // namespace detail
+
+// Объект-значение, хранящий значение типа T
+template <typename T>
+class ValueObject : public Object {
+public:
+    ValueObject(T v)  // NOLINT(google-explicit-constructor,hicpp-explicit-conversions)
+        : Object(detail::ValueTypeTag<T>()),
+          value_(v) {
+    }
+
+    void Print(std::ostream& os, [[maybe_unused]] Context& context) override {
+        os << value_;
+    }
+
+    [[nodiscard]] const T& GetValue() const {
+        return value_;
+    }
+
+    [[nodiscard]] T& GetValue() {
+        return value_;
+    }
+
+private:
+    T value_;
+};
+
+// быстрый вывод числа: to_chars в локальный буфер вместо operator<<
+template <>
+inline void ValueObject<int>::Print(std::ostream& os, [[maybe_unused]] Context& context) {
+    char buffer[16];
+    auto result = std::to_chars(std::begin(buffer), std::end(buffer), value_);
+    os.write(buffer, result.ptr - buffer);
+}
+
+// Строковое значение
+using String = ValueObject<std::string>;
+// Числовое значение
+using Number = ValueObject<int>;
+
+// Логическое значение
+class Bool : public ValueObject<bool> {
+public:
+    using ValueObject<bool>::ValueObject;
+
+    void Print(std::ostream& os, Context& context) override;
+};
+
+namespace detail {
+template <>
+inline constexpr ObjectType kTypeTag<Number> = ObjectType::Number;
+template <>
+inline constexpr ObjectType kTypeTag<Bool> = ObjectType::Bool;
+template <>
+inline constexpr ObjectType kTypeTag<String> = ObjectType::String;
+}  // namespace detail
+
+// Специальный класс-обёртка, предназначенный для хранения объекта в Mython-программе.
+// Значения Number и Bool хранятся во встроенном буфере без обращения к куче,
+// остальные объекты - в shared_ptr
 class ObjectHolder {
 public:
     // Создаёт пустое значение
     ObjectHolder() = default;
 
+    ObjectHolder(const ObjectHolder& other);
+    ObjectHolder(ObjectHolder&& other) noexcept;
+    ObjectHolder& operator=(const ObjectHolder& other);
+    ObjectHolder& operator=(ObjectHolder&& other) noexcept;
+    ~ObjectHolder();
+
     // Возвращает ObjectHolder, владеющий объектом типа T
     // Тип T - конкретный класс-наследник Object.
     // object копируется или перемещается в кучу
     template <typename T>
     [[nodiscard]] static ObjectHolder Own(T&& object) {
-        return ObjectHolder(std::make_shared<T>(std::forward<T>(object)));
+        return ObjectHolder(std::make_shared<std::decay_t<T>>(std::forward<T>(object)));
+    }
+
+    // Число и логическое значение помещаются во встроенный буфер,
+    // не выделяя память в куче
+    [[nodiscard]] static ObjectHolder Own(Number object);
+    [[nodiscard]] static ObjectHolder Own(Bool object);
+
+    /*
+     * Возвращает холдер числа value. Предпочтительное написание на горячих
+     * путях: значение лежит прямо в холдере (см. Own(Number)), поэтому
+     * возврат - копирование слова, без выделений памяти и без обращений
+     * к таблице предразмещённых объектов
+     */
+    [[nodiscard]] static ObjectHolder FromInt(int value) {
+        return Own(Number(value));
+    }
+
+    // Возвращает холдер значения Bool value (см. FromInt)
+    [[nodiscard]] static ObjectHolder FromBool(bool value) {
+        return Own(Bool(value));
     }
 
     // Создаёт ObjectHolder, не владеющий объектом (аналог слабой ссылки)
     [[nodiscard]] static ObjectHolder Share(Object& object);
+
+    /*
+     * Создаёт заимствованную ссылку на object: холдер без блока владения,
+     * чьи копирование и разрушение вообще не трогают счётчик ссылок
+     * (в отличие от Share, у которого есть собственный атомарный счётчик).
+     * Вызывающий обязан гарантировать, что object переживёт холдер и все
+     * его копии - см. ExecutionSession
+     */
+    [[nodiscard]] static ObjectHolder Borrow(Object& object);
     // Создаёт пустой ObjectHolder, соответствующий значению None
     [[nodiscard]] static ObjectHolder None();
 
@@ -57,41 +212,238 @@ public:
     // объект данного типа
     template <typename T>
     [[nodiscard]] T* TryAs() const {
-        return dynamic_cast<T*>(this->Get());
+        if constexpr (detail::kTypeTag<T> != ObjectType::Other) {
+            // тип с тегом: сравнение тега вместо dynamic_cast
+            Object* obj = this->Get();
+            if ((obj != nullptr) && (obj->GetType() == detail::kTypeTag<T>)) {
+                return static_cast<T*>(obj);
+            }
+            return nullptr;
+        }
+        else {
+            return dynamic_cast<T*>(this->Get());
+        }
     }
 
     // Возвращает true, если ObjectHolder не пуст
     explicit operator bool() const;
 
+    // Возвращает true, если холдер - единственный владелец своего объекта
+    // в куче (объект никому больше не виден и его можно менять на месте).
+    // Для встроенных значений, None и невладеющих холдеров (Share) - false
+    [[nodiscard]] bool IsUniquelyOwned() const;
+
 private:
+    // способ хранения объекта
+    enum class Repr : uint8_t {
+        Empty,         // пустое значение (None)
+        InlineNumber,  // Number во встроенном буфере
+        InlineBool,    // Bool во встроенном буфере
+        Shared,        // объект в shared_ptr
+    };
+
     explicit ObjectHolder(std::shared_ptr<Object> data);
     void AssertIsValid() const;
 
+    // копирует встроенное значение из other в собственный буфер
+    void CopyInline(const ObjectHolder& other);
+    // разрушает встроенное значение, если оно есть
+    void DestroyInline();
+
     std::shared_ptr<Object> data_;
+    Repr repr_ = Repr::Empty;
+    // буфер для встроенных Number и Bool
+    alignas(Number) unsigned char
+        inline_storage_[sizeof(Number) > sizeof(Bool) ? sizeof(Number) : sizeof(Bool)];
 };
 
-// Объект-значение, хранящий значение типа T
-template <typename T>
-class ValueObject : public Object {
+/*
+ * Сессионный режим выполнения для однопоточных встраиваний: пока на
+ * потоке жив хотя бы один ExecutionSession, чтения переменных, помеченные
+ * как неубегающие (условия if/while, аргументы print - см.
+ * ast::VariableValue::MarkNonEscapingRead), возвращают заимствованный
+ * холдер (см. ObjectHolder::Borrow) вместо копии с атомарным счётчиком
+ * ссылок. Такое значение только читается и не переживает Execute своей
+ * инструкции, поэтому перепривязка переменной следующей инструкцией
+ * безопасна. Чтения в убегающих позициях (правые части присваиваний,
+ * аргументы вызовов, return) всегда возвращают владеющую копию.
+ * Режим действует на текущий поток и по умолчанию выключен
+ */
+class ExecutionSession {
 public:
-    ValueObject(T v)  // NOLINT(google-explicit-constructor,hicpp-explicit-conversions)
-        : value_(v) {
+    ExecutionSession();
+    ~ExecutionSession();
+
+    ExecutionSession(const ExecutionSession&) = delete;
+    ExecutionSession& operator=(const ExecutionSession&) = delete;
+
+    // активна ли сессия на текущем потоке
+    [[nodiscard]] static bool IsActive();
+};
+
+/*
+ * Таблица символов: связывает имена (переменных или полей объекта) со
+ * значениями. Хранение основано на формах (см. Shape): имена отображаются
+ * в индексы слотов общей для одинаковых наборов имён формой, а сама таблица
+ * держит только плоский вектор значений - без собственной хеш-таблицы
+ */
+class Closure {
+public:
+    using value_type = std::pair<Symbol, ObjectHolder>;
+    using Storage = std::vector<value_type>;
+    using iterator = Storage::iterator;
+    using const_iterator = Storage::const_iterator;
+
+    Closure() : shape_(&Shape::Root()) {
     }
 
-    void Print(std::ostream& os, [[maybe_unused]] Context& context) override {
-        os << value_;
+    Closure(std::initializer_list<std::pair<std::string, ObjectHolder>> init) : Closure() {
+        for (const auto& [name, value] : init) {
+            (*this)[Intern(name)] = value;
+        }
     }
 
-    [[nodiscard]] const T& GetValue() const {
-        return value_;
+    // Возвращает индекс слота символа symbol либо -1, если символа нет
+    [[nodiscard]] int SlotOf(Symbol symbol) const {
+        return shape_->SlotOf(symbol);
+    }
+
+    // Возвращает форму таблицы; форма меняется при добавлении символа
+    [[nodiscard]] const Shape* GetShape() const {
+        return shape_;
+    }
+
+    // Возвращает значение в слоте slot
+    ObjectHolder& ValueAt(size_t slot) {
+        return slots_[slot].second;
+    }
+
+    [[nodiscard]] const ObjectHolder& ValueAt(size_t slot) const {
+        return slots_[slot].second;
+    }
+
+    ObjectHolder& operator[](Symbol symbol) {
+        int slot = shape_->SlotOf(symbol);
+        if (slot < 0) {
+            return Append(symbol);
+        }
+        return slots_[slot].second;
+    }
+
+    ObjectHolder& operator[](const std::string& name) {
+        return (*this)[Intern(name)];
+    }
+
+    ObjectHolder& at(Symbol symbol) {
+        int slot = shape_->SlotOf(symbol);
+        if (slot < 0) {
+            throw std::out_of_range("Closure::at");
+        }
+        return slots_[slot].second;
+    }
+
+    [[nodiscard]] const ObjectHolder& at(Symbol symbol) const {
+        int slot = shape_->SlotOf(symbol);
+        if (slot < 0) {
+            throw std::out_of_range("Closure::at");
+        }
+        return slots_[slot].second;
+    }
+
+    ObjectHolder& at(const std::string& name) {
+        return at(Intern(name));
+    }
+
+    [[nodiscard]] const ObjectHolder& at(const std::string& name) const {
+        return at(Intern(name));
+    }
+
+    [[nodiscard]] size_t count(Symbol symbol) const {
+        return shape_->SlotOf(symbol) < 0 ? 0 : 1;
+    }
+
+    [[nodiscard]] size_t count(const std::string& name) const {
+        return count(Intern(name));
+    }
+
+    iterator find(Symbol symbol) {
+        int slot = shape_->SlotOf(symbol);
+        if (slot < 0) {
+            return slots_.end();
+        }
+        return slots_.begin() + slot;
+    }
+
+    [[nodiscard]] const_iterator find(Symbol symbol) const {
+        int slot = shape_->SlotOf(symbol);
+        if (slot < 0) {
+            return slots_.end();
+        }
+        return slots_.begin() + slot;
+    }
+
+    iterator find(const std::string& name) {
+        return find(Intern(name));
+    }
+
+    [[nodiscard]] const_iterator find(const std::string& name) const {
+        return find(Intern(name));
+    }
+
+    std::pair<iterator, bool> insert(std::pair<std::string, ObjectHolder> value) {
+        Symbol symbol = Intern(value.first);
+        int slot = shape_->SlotOf(symbol);
+        if (slot >= 0) {
+            return {slots_.begin() + slot, false};
+        }
+        Append(symbol) = std::move(value.second);
+        return {slots_.end() - 1, true};
+    }
+
+    iterator begin() {
+        return slots_.begin();
+    }
+
+    iterator end() {
+        return slots_.end();
+    }
+
+    [[nodiscard]] const_iterator begin() const {
+        return slots_.begin();
+    }
+
+    [[nodiscard]] const_iterator end() const {
+        return slots_.end();
+    }
+
+    [[nodiscard]] size_t size() const {
+        return slots_.size();
+    }
+
+    [[nodiscard]] bool empty() const {
+        return slots_.empty();
+    }
+
+    void clear() {
+        slots_.clear();
+        shape_ = &Shape::Root();
+    }
+
+    void reserve(size_t count) {
+        slots_.reserve(count);
     }
 
 private:
-    T value_;
-};
+    // добавляет слот для символа symbol, переводя таблицу в дочернюю форму
+    ObjectHolder& Append(Symbol symbol) {
+        shape_ = &shape_->Transition(symbol);
+        slots_.emplace_back(symbol, ObjectHolder());
+        return slots_.back().second;
+    }
 
-// Таблица символов, связывающая имя объекта с его значением
-using Closure = std::unordered_map<std::string, ObjectHolder>;
+    Shape* shape_;  // текущая форма: имя -> слот
+    Storage slots_;       // значения слотов формы
+};
 
 // Проверяет, содержится ли в object значение, приводимое к True
 // Для отличных от нуля чисел, True и непустых строк возвращается true. В остальных случаях - false.
@@ -101,22 +453,53 @@ bool IsTrue(const ObjectHolder& object);
 class Executable {
 public:
     virtual ~Executable() = default;
+
+    // Возвращает номер строки исходного текста, с которой начинается
+    // инструкция, либо 0, если он неизвестен
+    [[nodiscard]] int GetSourceLine() const {
+        return source_line_;
+    }
+
+    // Привязывает инструкцию к строке исходного текста line
+    void SetSourceLine(int line) {
+        source_line_ = line;
+    }
     // Выполняет действие над объектами внутри closure, используя context
     // Возвращает результирующее значение либо None
     virtual ObjectHolder Execute(Closure& closure, Context& context) = 0;
-};
 
-// Строковое значение
-using String = ValueObject<std::string>;
-// Числовое значение
-using Number = ValueObject<int>;
+    // Компилирует инструкцию в байт-код через compiler.
+    // Возвращает false, если инструкция компилятором не поддерживается -
+    // в этом случае вызывающая сторона выполняет дерево через Execute
+    virtual bool Compile(vm::Compiler& /*compiler*/) const {
+        return false;
+    }
 
-// Логическое значение
-class Bool : public ValueObject<bool> {
-public:
-    using ValueObject<bool>::ValueObject;
+    // Узлы AST могут размещаться в арене (см. arena.h): пока в потоке
+    // активен Arena::Scope, operator new берёт память из арены,
+    // а operator delete такую память не освобождает -
+    // она вернётся системе вместе с ареной
+    static void* operator new(std::size_t size);
+    static void operator delete(void* ptr) noexcept;
 
-    void Print(std::ostream& os, Context& context) override;
+    /*
+     * Помечает инструкцию как стоящую в позиции инструкции (прямой потомок
+     * составной инструкции): её результат заведомо отбрасывается, никуда
+     * не сохраняется и из Execute наружу не уходит. Помеченный узел вправе
+     * не материализовывать возвращаемое значение и вернуть None
+     */
+    void MarkResultDiscarded() {
+        result_discarded_ = true;
+    }
+
+    // результат этой инструкции отбрасывается вызывающим
+    [[nodiscard]] bool IsResultDiscarded() const {
+        return result_discarded_;
+    }
+
+private:
+    int source_line_ = 0;  // строка исходного текста (0 - неизвестна)
+    bool result_discarded_ = false;  // результат никому не нужен
 };
 
 // Метод класса
@@ -127,6 +510,9 @@ struct Method {
     std::vector<std::string> formal_params;
     // Тело метода
     std::unique_ptr<Executable> body;
+    // Интернированные имена формальных параметров.
+    // Заполняется конструктором Class для быстрого связывания аргументов
+    std::vector<Symbol> formal_param_symbols = {};
 };
 
 // Класс
@@ -139,6 +525,9 @@ public:
     // Возвращает указатель на метод name или nullptr, если метод с таким именем отсутствует
     [[nodiscard]] const Method* GetMethod(const std::string& name) const;
 
+    // Возвращает указатель на метод с интернированным именем name или nullptr
+    [[nodiscard]] const Method* GetMethod(Symbol name) const;
+
     // Возвращает имя класса
     [[nodiscard]] const std::string& GetName() const;
 
@@ -149,7 +538,11 @@ private:
     std::string name_;             // имя класса
     std::vector<Method> methods_;  // методы класса
     const Class* parent_;          // родительский класс
-    std::unordered_map<std::string, const Method*> v_table_; // таблица функций класса
+    // Таблица функций класса: плотный вектор, индексируемый номером слота.
+    // Подкласс копирует раскладку родителя, поэтому унаследованные и
+    // переопределённые методы лежат в тех же слотах, что и у родителя
+    std::unordered_map<Symbol, uint32_t> method_slots_;  // имя метода -> слот
+    std::vector<const Method*> v_table_;                 // слот -> метод
 };
 
 // Экземпляр класса
@@ -172,9 +565,31 @@ public:
     ObjectHolder Call(const std::string& method, const std::vector<ObjectHolder>& actual_args,
                       Context& context);
 
+    /*
+     * Вызывает у объекта уже найденный метод method, минуя поиск по имени.
+     * Указатель должен быть получен через GetClass().GetMethod() для класса
+     * этого объекта; количество actual_args должно совпадать с числом
+     * формальных параметров метода
+     */
+    ObjectHolder CallMethod(const Method* method, const std::vector<ObjectHolder>& actual_args,
+                            Context& context);
+
+    // Возвращает класс объекта
+    [[nodiscard]] const Class& GetClass() const {
+        return class_;
+    }
+
     // Возвращает true, если объект имеет метод method, принимающий argument_count параметров
     [[nodiscard]] bool HasMethod(const std::string& method, size_t argument_count) const;
 
+    // Возвращает true, если объект имеет метод с интернированным именем method,
+    // принимающий argument_count параметров
+    [[nodiscard]] bool HasMethod(Symbol method, size_t argument_count) const;
+
+    // Вызывает у объекта метод с интернированным именем method (см. Call)
+    ObjectHolder Call(Symbol method, const std::vector<ObjectHolder>& actual_args,
+                      Context& context);
+
     // Возвращает ссылку на Closure, содержащий поля объекта
     [[nodiscard]] Closure& Fields();
     // Возвращает константную ссылку на Closure, содержащую поля объекта
@@ -185,6 +600,13 @@ private:
     Closure fields_;      // поля класса
 };
 
+namespace detail {
+template <>
+inline constexpr ObjectType kTypeTag<Class> = ObjectType::Class;
+template <>
+inline constexpr ObjectType kTypeTag<ClassInstance> = ObjectType::ClassInstance;
+}  // namespace detail
+
 /*
  * Возвращает true, если lhs и rhs содержат одинаковые числа, строки или значения типа Bool.
  * Если lhs - объект с методом __eq__, функция возвращает результат вызова lhs.__eq__(rhs),
@@ -213,6 +635,26 @@ bool LessOrEqual(const ObjectHolder& lhs, const ObjectHolder& rhs, Context& cont
 // Возвращает значение, противоположное Less(lhs, rhs, context)
 bool GreaterOrEqual(const ObjectHolder& lhs, const ObjectHolder& rhs, Context& context);
 
+// Результат трёхстороннего сравнения
+enum class Ordering {
+    Less,
+    Equal,
+    Greater,
+};
+
+/*
+ * Трёхстороннее сравнение lhs и rhs: операнды и их типы разбираются один раз,
+ * и из результата выводятся отношения порядка. Числа, строки и значения Bool
+ * сравниваются по значению; None не упорядочен даже с самим собой.
+ * Экземпляр класса с методом __cmp__(rhs),
+ * возвращающим отрицательное, нулевое или положительное число, сравнивается
+ * одним вызовом этого метода; без __cmp__ порядок восстанавливается через
+ * __lt__ и __eq__. Если объекты несравнимы, выбрасывается runtime_error.
+ *
+ * Параметр context задаёт контекст для выполнения методов сравнения
+ */
+Ordering Compare(const ObjectHolder& lhs, const ObjectHolder& rhs, Context& context);
+
 // Контекст-заглушка, применяется в тестах.
 // В этом контексте весь вывод перенаправляется в строковый поток вывода output
 struct DummyContext : Context {
@@ -238,4 +680,85 @@ private:
     std::ostream& output_;
 };
 
+/*
+ * Контекст с крупноблочным выводом: печать накапливается в буфере размера
+ * buffer_size и уходит в целевой поток output большими блоками - при
+ * заполнении буфера, по явному вызову Flush() и в деструкторе.
+ * Существенно снижает накладные расходы iostream и число системных
+ * вызовов в программах с большим объёмом print
+ */
+class BufferedContext : public Context {
+public:
+    // размер буфера по умолчанию
+    static constexpr size_t DEFAULT_BUFFER_SIZE = 1024 * 1024;
+
+    explicit BufferedContext(std::ostream& output, size_t buffer_size = DEFAULT_BUFFER_SIZE)
+        : buffer_(output, buffer_size),
+          stream_(&buffer_) {
+    }
+
+    ~BufferedContext() {
+        buffer_.Flush();
+    }
+
+    BufferedContext(const BufferedContext&) = delete;
+    BufferedContext& operator=(const BufferedContext&) = delete;
+
+    std::ostream& GetOutputStream() override {
+        return stream_;
+    }
+
+    // Дописывает накопленный буфер в целевой поток и сбрасывает его
+    void Flush() {
+        buffer_.Flush();
+        buffer_.FlushTarget();
+    }
+
+private:
+    // буфер, пишущий в целевой поток только большими блоками
+    class Buffer : public std::streambuf {
+    public:
+        Buffer(std::ostream& target, size_t size)
+            : target_(target),
+              storage_(size) {
+            setp(storage_.data(), storage_.data() + storage_.size());
+        }
+
+        void Flush() {
+            auto count = pptr() - pbase();
+            if (count > 0) {
+                target_.write(pbase(), count);
+                pbump(static_cast<int>(-count));
+            }
+        }
+
+        void FlushTarget() {
+            target_.flush();
+        }
+
+    protected:
+        int_type overflow(int_type ch) override {
+            Flush();
+            if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+                *pptr() = traits_type::to_char_type(ch);
+                pbump(1);
+            }
+            return ch;
+        }
+
+        int sync() override {
+            Flush();
+            FlushTarget();
+            return 0;
+        }
+
+    private:
+        std::ostream& target_;
+        std::vector<char> storage_;
+    };
+
+    Buffer buffer_;
+    std::ostream stream_;
+};
+
 }  // namespace runtime
\ No newline at end of file
@@ -19,7 +19,8 @@ public:
     }
 
     Logger(const Logger& rhs)
-        : id_(rhs.id_)  //
+        : Object(rhs),
+          id_(rhs.id_)  //
     {
         ++instance_count;
     }
@@ -199,6 +200,28 @@ void TestNonowning() {
     ASSERT_EQUAL(context.output.str(), "784"sv);
 }
 
+void TestBorrowed() {
+    ASSERT_EQUAL(Logger::instance_count, 0);
+    Logger logger(903);
+    {
+        // заимствованный холдер и его копии объектом не владеют
+        auto oh = ObjectHolder::Borrow(logger);
+        ASSERT(oh);
+        ASSERT(oh.Get() == &logger);
+        ASSERT(!oh.IsUniquelyOwned());
+        ObjectHolder copy = oh;  // NOLINT(performance-unnecessary-copy-initialization)
+        ASSERT(copy.Get() == &logger);
+    }
+    ASSERT_EQUAL(Logger::instance_count, 1);
+
+    ASSERT(!ExecutionSession::IsActive());
+    {
+        ExecutionSession session;
+        ASSERT(ExecutionSession::IsActive());
+    }
+    ASSERT(!ExecutionSession::IsActive());
+}
+
 void TestOwning() {
     ASSERT_EQUAL(Logger::instance_count, 0);
     {
@@ -474,6 +497,97 @@ void TestComparison() {
     }
 }
 
+void TestCmpProtocol() {
+    DummyContext context;
+
+    // класс с __cmp__: порядок восстанавливается одним вызовом через Compare
+    auto cmp_method = [](Closure& closure, Context& /*ctx*/) {
+        auto* self = closure.at("self"s).TryAs<ClassInstance>();
+        int lhs_value = self->Fields().at("value"s).TryAs<Number>()->GetValue();
+        int rhs_value = closure.at("rhs"s).TryAs<Number>()->GetValue();
+        return ObjectHolder::FromInt(lhs_value - rhs_value);
+    };
+    vector<Method> methods;
+    methods.push_back({"__cmp__"s, {"rhs"s}, make_unique<TestMethodBody>(cmp_method)});
+    Class cls{"ValueHolder"s, std::move(methods), nullptr};
+    ClassInstance two{cls};
+    two.Fields()["value"s] = ObjectHolder::FromInt(2);
+
+    auto lhs = ObjectHolder::Share(two);
+    auto num = [](int value) { return ObjectHolder::FromInt(value); };
+
+    ASSERT(Less(lhs, num(3), context));
+    ASSERT(!Less(lhs, num(2), context));
+    ASSERT(Greater(lhs, num(1), context));
+    ASSERT(!Greater(lhs, num(2), context));
+    ASSERT(LessOrEqual(lhs, num(2), context));
+    ASSERT(LessOrEqual(lhs, num(3), context));
+    ASSERT(!LessOrEqual(lhs, num(1), context));
+    ASSERT(GreaterOrEqual(lhs, num(2), context));
+    ASSERT(GreaterOrEqual(lhs, num(1), context));
+    ASSERT(!GreaterOrEqual(lhs, num(3), context));
+    ASSERT(Equal(lhs, num(2), context));
+    ASSERT(NotEqual(lhs, num(5), context));
+
+    // __cmp__, вернувший не число - ошибка сравнения
+    auto bad_cmp = [](Closure& /*closure*/, Context& /*ctx*/) {
+        return ObjectHolder::Own(String{"oops"s});
+    };
+    vector<Method> bad_methods;
+    bad_methods.push_back({"__cmp__"s, {"rhs"s}, make_unique<TestMethodBody>(bad_cmp)});
+    Class bad_cls{"BadCmp"s, std::move(bad_methods), nullptr};
+    ClassInstance bad{bad_cls};
+
+    ASSERT_THROWS(Less(ObjectHolder::Share(bad), num(1), context), runtime_error);
+    ASSERT_THROWS(Greater(ObjectHolder::Share(bad), num(1), context), runtime_error);
+    ASSERT_THROWS(LessOrEqual(ObjectHolder::Share(bad), num(1), context), runtime_error);
+    ASSERT_THROWS(GreaterOrEqual(ObjectHolder::Share(bad), num(1), context), runtime_error);
+}
+
+void TestFieldShapes() {
+    // объекты, получившие поля в одном порядке, разделяют одну форму
+    Class cls("X"s, {}, nullptr);
+    ClassInstance first(cls);
+    ClassInstance second(cls);
+    ASSERT(first.Fields().GetShape() == second.Fields().GetShape());
+
+    first.Fields()["a"s] = ObjectHolder::Own(Number{1});
+    first.Fields()["b"s] = ObjectHolder::Own(Number{2});
+    second.Fields()["a"s] = ObjectHolder::Own(Number{10});
+    ASSERT(first.Fields().GetShape() != second.Fields().GetShape());
+    second.Fields()["b"s] = ObjectHolder::Own(Number{20});
+    ASSERT(first.Fields().GetShape() == second.Fields().GetShape());
+
+    // значения при этом лежат в своих слотах каждого объекта
+    ASSERT_EQUAL(first.Fields().at("b"s).TryAs<Number>()->GetValue(), 2);
+    ASSERT_EQUAL(second.Fields().at("b"s).TryAs<Number>()->GetValue(), 20);
+
+    // иной порядок полей даёт другую форму
+    ClassInstance third(cls);
+    third.Fields()["b"s] = ObjectHolder::Own(Number{2});
+    third.Fields()["a"s] = ObjectHolder::Own(Number{1});
+    ASSERT(first.Fields().GetShape() != third.Fields().GetShape());
+}
+
+void TestBufferedContext() {
+    ostringstream out;
+    {
+        BufferedContext context(out, 64);
+        Number number(42);
+        String text("test"s);
+        number.Print(context.GetOutputStream(), context);
+        context.GetOutputStream() << ' ';
+        text.Print(context.GetOutputStream(), context);
+        // вывод копится в буфере контекста
+        ASSERT_EQUAL(out.str(), ""s);
+        context.Flush();
+        ASSERT_EQUAL(out.str(), "42 test"s);
+        context.GetOutputStream() << '!';
+    }
+    // остаток буфера дописывается в деструкторе
+    ASSERT_EQUAL(out.str(), "42 test!"s);
+}
+
 void TestClass() {
     vector<Method> methods;
     Closure* passed_closure = nullptr;
@@ -538,12 +652,16 @@ void RunObjectsTests(TestRunner& tr) {
     RUN_TEST(tr, runtime::TestMethodInvocation);
     RUN_TEST(tr, runtime::TestIsTrue);
     RUN_TEST(tr, runtime::TestComparison);
+    RUN_TEST(tr, runtime::TestCmpProtocol);
+    RUN_TEST(tr, runtime::TestFieldShapes);
+    RUN_TEST(tr, runtime::TestBufferedContext);
     RUN_TEST(tr, runtime::TestClass);
     RUN_TEST(tr, runtime::TestClassInstance);
 }
 
 void RunObjectHolderTests(TestRunner& tr) {
     RUN_TEST(tr, runtime::TestNonowning);
+    RUN_TEST(tr, runtime::TestBorrowed);
     RUN_TEST(tr, runtime::TestOwning);
     RUN_TEST(tr, runtime::TestMove);
     RUN_TEST(tr, runtime::TestNullptr);
@@ -0,0 +1,56 @@
+#include "shape.h"
+
+using namespace std;
+
+namespace runtime {
+
+Shape& Shape::Root() {
+    static Shape root;
+    return root;
+}
+
+Shape& Shape::Transition(Symbol field) {
+    // быстрый путь: существующий переход ищем без блокировки
+    for (const TransitionNode* node = transition_list_.load(memory_order_acquire);
+         node != nullptr; node = node->next) {
+        if (node->field == field) {
+            return *node->child;
+        }
+    }
+
+    lock_guard<mutex> lock(guard_);
+    auto& child = transitions_[field];
+    if (!child) {
+        child = unique_ptr<Shape>(new Shape(*this, field));
+        // публикуем новое звено; уже опубликованные не меняются
+        auto* node = new TransitionNode{field, child.get(),
+                                        transition_list_.load(memory_order_relaxed)};
+        transition_list_.store(node, memory_order_release);
+    }
+    return *child;
+}
+
+Shape::~Shape() {
+    TransitionNode* node = transition_list_.load(memory_order_relaxed);
+    while (node != nullptr) {
+        TransitionNode* next = node->next;
+        delete node;
+        node = next;
+    }
+}
+
+int Shape::SlotOf(Symbol field) const {
+    auto it = slots_.find(field);
+    if (it == slots_.end()) {
+        return -1;
+    }
+    return it->second;
+}
+
+Shape::Shape(const Shape& parent, Symbol field) : slots_(parent.slots_),
+                                                  fields_(parent.fields_) {
+    slots_[field] = static_cast<int>(fields_.size());
+    fields_.push_back(field);
+}
+
+}  // namespace runtime
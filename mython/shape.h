@@ -0,0 +1,74 @@
+#pragma once
+
+#include "symbol.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace runtime {
+
+/*
+ * Форма (hidden class) набора полей: отображает имена полей в индексы
+ * плотных слотов. Объекты, получающие поля в одном и том же порядке,
+ * проходят одну и ту же цепочку форм и разделяют таблицы слотов,
+ * поэтому сам объект хранит только плоский вектор значений.
+ * Таблица слотов формы неизменяема после создания, наращиваются
+ * только переходы к дочерним формам
+ */
+class Shape {
+public:
+    Shape(const Shape&) = delete;
+    Shape& operator=(const Shape&) = delete;
+
+    // Возвращает корневую форму без полей
+    static Shape& Root();
+
+    /*
+     * Возвращает форму с полем field, добавленным к этой форме.
+     * Существующий переход находится по неизменяемому списку без
+     * блокировки - это горячий путь каждого связывания кадра вызова;
+     * мьютекс берётся только для вставки недостающего перехода
+     */
+    Shape& Transition(Symbol field);
+
+    ~Shape();
+
+    // Возвращает индекс слота поля field либо -1, если поля нет
+    [[nodiscard]] int SlotOf(Symbol field) const;
+
+    // Возвращает количество слотов формы
+    [[nodiscard]] size_t SlotCount() const {
+        return fields_.size();
+    }
+
+    // Возвращает имя поля в слоте slot
+    [[nodiscard]] Symbol FieldAt(size_t slot) const {
+        return fields_[slot];
+    }
+
+private:
+    Shape() = default;
+    // форма parent с добавленным полем field
+    Shape(const Shape& parent, Symbol field);
+
+    // звено неизменяемого списка переходов: опубликованные звенья
+    // не меняются и не освобождаются до разрушения формы, поэтому
+    // читатели обходят список без блокировки
+    struct TransitionNode {
+        Symbol field;
+        Shape* child;
+        TransitionNode* next;
+    };
+
+    std::unordered_map<Symbol, int> slots_;  // имя поля -> индекс слота
+    std::vector<Symbol> fields_;             // индекс слота -> имя поля
+    std::mutex guard_;                       // защищает только transitions_
+    std::unordered_map<Symbol, std::unique_ptr<Shape>> transitions_;
+    // список переходов для чтения без блокировки (дублирует transitions_)
+    std::atomic<TransitionNode*> transition_list_{nullptr};
+};
+
+}  // namespace runtime
@@ -1,5 +1,9 @@
 #include "statement.h"
 
+#include "profile.h"
+
+#include "vm.h"
+
 #include <iostream>
 #include <sstream>
 
@@ -14,30 +18,78 @@ using runtime::ObjectHolder;
 namespace {
 const string ADD_METHOD = "__add__"s;
 const string INIT_METHOD = "__init__"s;
+
+// помечает node как неубегающее чтение, если это чтение переменной
+void MarkIfVariableRead(Statement* node) {
+    if (auto* var = dynamic_cast<VariableValue*>(node)) {
+        var->MarkNonEscapingRead();
+    }
+}
 }  // namespace
 
 //-----------------------------------------------------------------------------
 
 VariableValue::VariableValue(const std::string& var_name) :
-    dotted_ids_({var_name}) {
+    dotted_ids_({runtime::Intern(var_name)}),
+    slot_caches_(1) {
 }
 
 VariableValue::VariableValue(std::vector<std::string> dotted_ids) :
-    dotted_ids_(move(dotted_ids)) {
+    slot_caches_(dotted_ids.size()) {
+    dotted_ids_.reserve(dotted_ids.size());
+    for (const auto& id : dotted_ids) {
+        dotted_ids_.push_back(runtime::Intern(id));
+    }
+}
+
+bool VariableValue::Compile(vm::Compiler& compiler) const {
+    // компилируется только доступ к простой переменной,
+    // цепочки полей объектов выполняются через Execute
+    if (dotted_ids_.size() != 1) {
+        return false;
+    }
+    compiler.Emit(vm::OpCode::LoadVar, compiler.AddName(runtime::SymbolName(dotted_ids_.front())));
+    return true;
 }
 
 ObjectHolder VariableValue::Execute(Closure& closure,
                                     [[maybe_unused]] Context& context) {
     size_t ids_count = dotted_ids_.size();
-    Closure new_closure = closure;
+    // идём по цепочке полей, не копируя таблицы символов
+    const Closure* current = &closure;
     for (size_t i = 0; i < ids_count; ++i) {
-        if (new_closure.count(dotted_ids_[i])) {
-            if (i == ids_count - 1) {
-                return new_closure.at(dotted_ids_[i]);
-            }
-            if (auto* base_ci = new_closure.at(dotted_ids_[i]).TryAs<runtime::ClassInstance>()) {
-                new_closure = base_ci->Fields();
+        // слот звена ищется по имени только при смене формы таблицы
+        const SlotCacheEntry* entry = slot_caches_[i].Get();
+        int slot;
+        if ((nullptr != entry) && (current->GetShape() == entry->shape)) {
+            slot = entry->slot;
+        }
+        else {
+            slot = current->SlotOf(dotted_ids_[i]);
+            SlotCacheEntry fresh;
+            fresh.shape = current->GetShape();
+            fresh.slot = slot;
+            // на мегаморфном месте публикация пропускается
+            slot_caches_[i].Update(fresh);
+        }
+        if (slot < 0) {
+            break;
+        }
+        const ObjectHolder& value = current->ValueAt(slot);
+        if (i == ids_count - 1) {
+            if (borrow_ok_ && runtime::ExecutionSession::IsActive()
+                && (value.Get() != nullptr)) {
+                // сессионный режим и неубегающее чтение: заимствуем
+                // значение из слота, не трогая атомарный счётчик владения
+                return ObjectHolder::Borrow(*value.Get());
             }
+            return value;
+        }
+        if (auto* base_ci = value.TryAs<runtime::ClassInstance>()) {
+            current = &base_ci->Fields();
+        }
+        else {
+            break;
         }
     }
     throw runtime_error(string(__func__) + " is failed");
@@ -46,12 +98,25 @@ ObjectHolder VariableValue::Execute(Closure& closure,
 //-----------------------------------------------------------------------------
 
 Assignment::Assignment(std::string var, std::unique_ptr<Statement> rv) :
-    var_(move(var)),
+    var_(runtime::Intern(var)),
     rv_(move(rv)) {
 }
 
+bool Assignment::Compile(vm::Compiler& compiler) const {
+    if (!compiler.CompileNode(*rv_)) {
+        return false;
+    }
+    compiler.Emit(vm::OpCode::StoreVar, compiler.AddName(runtime::SymbolName(var_)));
+    return true;
+}
+
 ObjectHolder Assignment::Execute(Closure& closure, Context& context) {
     closure[var_] = rv_.get()->Execute(closure, context);
+    if (IsResultDiscarded()) {
+        // в позиции инструкции значение никому не нужно -
+        // не плодим лишнюю ссылку на него
+        return ObjectHolder::None();
+    }
     return closure.at(var_);
 }
 
@@ -61,7 +126,7 @@ FieldAssignment::FieldAssignment(VariableValue object,
                                  std::string field_name,
                                  std::unique_ptr<Statement> rv) :
     object_(move(object)),
-    field_name_(move(field_name)),
+    field_name_(runtime::Intern(field_name)),
     rv_(move(rv)) {
 }
 
@@ -70,6 +135,9 @@ ObjectHolder FieldAssignment::Execute(Closure& closure, Context& context) {
     if (auto* base_ci = base.TryAs<runtime::ClassInstance>()) {
         base_ci->Fields()[field_name_] = rv_.get()->Execute(closure, context);
         closure[field_name_] = base_ci->Fields().at(field_name_);
+        if (IsResultDiscarded()) {
+            return ObjectHolder::None();
+        }
         return base_ci->Fields().at(field_name_);
     }
     throw runtime_error(string(__func__) + " is failed");
@@ -77,6 +145,11 @@ ObjectHolder FieldAssignment::Execute(Closure& closure, Context& context) {
 
 //-----------------------------------------------------------------------------
 
+bool None::Compile(vm::Compiler& compiler) const {
+    compiler.Emit(vm::OpCode::LoadNone);
+    return true;
+}
+
 runtime::ObjectHolder None::Execute([[maybe_unused]] runtime::Closure& closure,
                                     [[maybe_unused]] runtime::Context& context) {
     return {};
@@ -85,17 +158,32 @@ runtime::ObjectHolder None::Execute([[maybe_unused]] runtime::Closure& closure,
 //-----------------------------------------------------------------------------
 
 Print::Print(unique_ptr<Statement> argument) {
+    MarkIfVariableRead(argument.get());
     args_.push_back(move(argument));
 }
 
 Print::Print(vector<unique_ptr<Statement>> args) :
     args_(move(args)) {
+    // значения аргументов только печатаются и инструкцию не переживают
+    for (const auto& arg : args_) {
+        MarkIfVariableRead(arg.get());
+    }
 }
 
 unique_ptr<Print> Print::Variable(const std::string& name) {
     return make_unique<Print>(make_unique<VariableValue>(name));
 }
 
+bool Print::Compile(vm::Compiler& compiler) const {
+    for (const auto& arg : args_) {
+        if (!compiler.CompileNode(*arg)) {
+            return false;
+        }
+    }
+    compiler.Emit(vm::OpCode::Print, static_cast<uint32_t>(args_.size()));
+    return true;
+}
+
 ObjectHolder Print::Execute(Closure& closure, Context& context) {
     ostringstream os;
     for (size_t i = 0; i < args_.size(); ++i) {
@@ -110,7 +198,9 @@ ObjectHolder Print::Execute(Closure& closure, Context& context) {
             os << "None"s;
         }
     }
-    context.GetOutputStream() << os.str() << endl;
+    // '\n' вместо endl: print не сбрасывает поток, иначе BufferedContext
+    // выталкивал бы буфер на каждой печати
+    context.GetOutputStream() << os.str() << '\n';
     runtime::String str_obj(os.str());
     return ObjectHolder::Own(move(str_obj));
 }
@@ -133,7 +223,26 @@ ObjectHolder MethodCall::Execute(Closure& closure, Context& context) {
         for (const auto& arg : args_) {
             actual_args.push_back(arg.get()->Execute(closure, context));
         }
-        return ci->Call(method_, actual_args, context);
+        const runtime::Class* cls = &ci->GetClass();
+        const CallCacheEntry* entry = call_cache_.Get();
+        const runtime::Method* p_method;
+        if ((nullptr != entry) && (cls == entry->cls)) {
+            p_method = entry->method;
+        }
+        else {
+            // промах кеша - ищем метод и запоминаем его для этого класса
+            p_method = cls->GetMethod(method_);
+            if ((nullptr == p_method) || (args_.size() != p_method->formal_params.size())) {
+                // метода нет - Call выбросит исключение с его именем
+                return ci->Call(method_, actual_args, context);
+            }
+            CallCacheEntry fresh;
+            fresh.cls = cls;
+            fresh.method = p_method;
+            // на мегаморфном месте публикация пропускается
+            call_cache_.Update(fresh);
+        }
+        return ci->CallMethod(p_method, actual_args, context);
     }
     throw runtime_error(string(__func__) + " is failed");
 }
@@ -142,25 +251,29 @@ ObjectHolder MethodCall::Execute(Closure& closure, Context& context) {
 
 NewInstance::NewInstance(const runtime::Class& class_,
                          std::vector<std::unique_ptr<Statement>> args) :
-    ci_(class_),
+    class_(class_),
     args_(move(args)) {
 }
 
 NewInstance::NewInstance(const runtime::Class& class_) :
-    ci_(class_) {
+    class_(class_) {
 }
 
 ObjectHolder NewInstance::Execute(Closure& closure, Context& context) {
-    if (ci_.HasMethod(INIT_METHOD, args_.size())) {
+    // каждое выполнение создаёт собственный экземпляр: узел не хранит
+    // состояния запуска, поэтому дерево можно выполнять повторно
+    // и из нескольких потоков одновременно
+    ObjectHolder instance = ObjectHolder::Own(runtime::ClassInstance(class_));
+    auto* ci = instance.TryAs<runtime::ClassInstance>();
+    if (ci->HasMethod(INIT_METHOD, args_.size())) {
         vector<ObjectHolder> actual_args;
         actual_args.reserve(args_.size());
         for (const auto& arg : args_) {
             actual_args.push_back(arg.get()->Execute(closure, context));
         }
-        ci_.Call(INIT_METHOD, actual_args, context);
+        ci->Call(INIT_METHOD, actual_args, context);
     }
-    return ObjectHolder::Share(ci_);
-
+    return instance;
 }
 
 //-----------------------------------------------------------------------------
@@ -194,24 +307,52 @@ BinaryOperation::BinaryOperation(std::unique_ptr<Statement> lhs,
 
 //-----------------------------------------------------------------------------
 
+bool Add::Compile(vm::Compiler& compiler) const {
+    if (!compiler.CompileNode(*lhs_) || !compiler.CompileNode(*rhs_)) {
+        return false;
+    }
+    compiler.Emit(vm::OpCode::Add);
+    return true;
+}
+
 ObjectHolder Add::Execute(Closure& closure, Context& context) {
     ObjectHolder lhs_oh = lhs_.get()->Execute(closure, context);
     ObjectHolder rhs_oh = rhs_.get()->Execute(closure, context);
+    if (feedback_.IsIntSpecialized()) {
+        // специализированный путь: охранная проверка и сложение,
+        // без опроса строковой и классовой ветвей
+        auto* lhs_n = lhs_oh.TryAs<runtime::Number>();
+        auto* rhs_n = rhs_oh.TryAs<runtime::Number>();
+        if ((lhs_n != nullptr) && (rhs_n != nullptr)) {
+            return ObjectHolder::FromInt(lhs_n->GetValue() + rhs_n->GetValue());
+        }
+        // типы в этом месте изменились - возвращаемся на общий путь
+        feedback_.Deoptimize();
+    }
     if (auto* lhs_n = lhs_oh.TryAs<runtime::Number>()) {
         if (auto* rhs_n = rhs_oh.TryAs<runtime::Number>()) {
-            int val = lhs_n->GetValue() + rhs_n->GetValue();
-            runtime::Number result(val);
-            return ObjectHolder::Own(move(result));
+            feedback_.ObserveIntInt();
+            return ObjectHolder::FromInt(lhs_n->GetValue() + rhs_n->GetValue());
         }
+        feedback_.Deoptimize();
     }
     else if (auto* lhs_s = lhs_oh.TryAs<runtime::String>()) {
+        feedback_.Deoptimize();
         if (auto* rhs_s = rhs_oh.TryAs<runtime::String>()) {
+            if (lhs_oh.IsUniquelyOwned()) {
+                // левый операнд - временный результат (обычно предыдущей
+                // конкатенации): дописываем на месте, не копируя префикс.
+                // Цепочка a + b + ... + z становится линейной по объёму
+                lhs_s->GetValue() += rhs_s->GetValue();
+                return lhs_oh;
+            }
             string str = lhs_s->GetValue() + rhs_s->GetValue();
             runtime::String result(str);
             return ObjectHolder::Own(move(result));
         }
     }
     else if (auto* lhs_ci = lhs_oh.TryAs<runtime::ClassInstance>()) {
+        feedback_.Deoptimize();
         if (lhs_ci->HasMethod(ADD_METHOD, 1)) {
             return lhs_ci->Call(ADD_METHOD, { rhs_oh }, context);
         }
@@ -221,14 +362,20 @@ ObjectHolder Add::Execute(Closure& closure, Context& context) {
 
 //-----------------------------------------------------------------------------
 
+bool Sub::Compile(vm::Compiler& compiler) const {
+    if (!compiler.CompileNode(*lhs_) || !compiler.CompileNode(*rhs_)) {
+        return false;
+    }
+    compiler.Emit(vm::OpCode::Sub);
+    return true;
+}
+
 ObjectHolder Sub::Execute(Closure& closure, Context& context) {
     ObjectHolder lhs_oh = lhs_.get()->Execute(closure, context);
     ObjectHolder rhs_oh = rhs_.get()->Execute(closure, context);
     if (auto* lhs_n = lhs_oh.TryAs<runtime::Number>()) {
         if (auto* rhs_n = rhs_oh.TryAs<runtime::Number>()) {
-            int val = lhs_n->GetValue() - rhs_n->GetValue();
-            runtime::Number result(val);
-            return ObjectHolder::Own(move(result));
+            return ObjectHolder::FromInt(lhs_n->GetValue() - rhs_n->GetValue());
         }
     }
     throw runtime_error(string(__func__) + " is failed");
@@ -236,14 +383,20 @@ ObjectHolder Sub::Execute(Closure& closure, Context& context) {
 
 //-----------------------------------------------------------------------------
 
+bool Mult::Compile(vm::Compiler& compiler) const {
+    if (!compiler.CompileNode(*lhs_) || !compiler.CompileNode(*rhs_)) {
+        return false;
+    }
+    compiler.Emit(vm::OpCode::Mul);
+    return true;
+}
+
 ObjectHolder Mult::Execute(Closure& closure, Context& context) {
     ObjectHolder lhs_oh = lhs_.get()->Execute(closure, context);
     ObjectHolder rhs_oh = rhs_.get()->Execute(closure, context);
     if (auto* lhs_n = lhs_oh.TryAs<runtime::Number>()) {
         if (auto* rhs_n = rhs_oh.TryAs<runtime::Number>()) {
-            int val = lhs_n->GetValue() * rhs_n->GetValue();
-            runtime::Number result(val);
-            return ObjectHolder::Own(move(result));
+            return ObjectHolder::FromInt(lhs_n->GetValue() * rhs_n->GetValue());
         }
     }
     throw runtime_error(string(__func__) + " is failed");
@@ -251,15 +404,21 @@ ObjectHolder Mult::Execute(Closure& closure, Context& context) {
 
 //-----------------------------------------------------------------------------
 
+bool Div::Compile(vm::Compiler& compiler) const {
+    if (!compiler.CompileNode(*lhs_) || !compiler.CompileNode(*rhs_)) {
+        return false;
+    }
+    compiler.Emit(vm::OpCode::Div);
+    return true;
+}
+
 ObjectHolder Div::Execute(Closure& closure, Context& context) {
     ObjectHolder lhs_oh = lhs_.get()->Execute(closure, context);
     ObjectHolder rhs_oh = rhs_.get()->Execute(closure, context);
     if (auto* lhs_n = lhs_oh.TryAs<runtime::Number>()) {
         if (auto* rhs_n = rhs_oh.TryAs<runtime::Number>()) {
             if (int rhs_val = rhs_n->GetValue()) {
-                int val = lhs_n->GetValue() / rhs_val;
-                runtime::Number result(val);
-                return ObjectHolder::Own(move(result));
+                return ObjectHolder::FromInt(lhs_n->GetValue() / rhs_val);
             }
         }
     }
@@ -268,6 +427,14 @@ ObjectHolder Div::Execute(Closure& closure, Context& context) {
 
 //-----------------------------------------------------------------------------
 
+bool Or::Compile(vm::Compiler& compiler) const {
+    if (!compiler.CompileNode(*lhs_) || !compiler.CompileNode(*rhs_)) {
+        return false;
+    }
+    compiler.Emit(vm::OpCode::Or);
+    return true;
+}
+
 ObjectHolder Or::Execute(Closure& closure, Context& context) {
     ObjectHolder lhs_oh = lhs_.get()->Execute(closure, context);
     ObjectHolder rhs_oh = rhs_.get()->Execute(closure, context);
@@ -275,18 +442,15 @@ ObjectHolder Or::Execute(Closure& closure, Context& context) {
         if (!lhs_b->GetValue()) {
             if (auto* rhs_b = rhs_oh.TryAs<runtime::Bool>()) {
                 if (rhs_b->GetValue()) {
-                    runtime::Bool result(true);
-                    return ObjectHolder::Own(move(result));
+                    return ObjectHolder::FromBool(true);
                 }
                 else {
-                    runtime::Bool result(false);
-                    return ObjectHolder::Own(move(result));
+                    return ObjectHolder::FromBool(false);
                 }
             }
         }
         else {
-            runtime::Bool result(true);
-            return ObjectHolder::Own(move(result));
+            return ObjectHolder::FromBool(true);
         }
     }
     throw runtime_error(string(__func__) + " is failed");
@@ -294,6 +458,14 @@ ObjectHolder Or::Execute(Closure& closure, Context& context) {
 
 //-----------------------------------------------------------------------------
 
+bool And::Compile(vm::Compiler& compiler) const {
+    if (!compiler.CompileNode(*lhs_) || !compiler.CompileNode(*rhs_)) {
+        return false;
+    }
+    compiler.Emit(vm::OpCode::And);
+    return true;
+}
+
 ObjectHolder And::Execute(Closure& closure, Context& context) {
     ObjectHolder lhs_oh = lhs_.get()->Execute(closure, context);
     ObjectHolder rhs_oh = rhs_.get()->Execute(closure, context);
@@ -301,18 +473,15 @@ ObjectHolder And::Execute(Closure& closure, Context& context) {
         if (lhs_b->GetValue()) {
             if (auto* rhs_b = rhs_oh.TryAs<runtime::Bool>()) {
                 if (rhs_b->GetValue()) {
-                    runtime::Bool result(true);
-                    return ObjectHolder::Own(move(result));
+                    return ObjectHolder::FromBool(true);
                 }
                 else {
-                    runtime::Bool result(false);
-                    return ObjectHolder::Own(move(result));
+                    return ObjectHolder::FromBool(false);
                 }
             }
         }
         else {
-            runtime::Bool result(false);
-            return ObjectHolder::Own(move(result));
+            return ObjectHolder::FromBool(false);
         }
     }
     throw runtime_error(string(__func__) + " is failed");
@@ -320,19 +489,40 @@ ObjectHolder And::Execute(Closure& closure, Context& context) {
 
 //-----------------------------------------------------------------------------
 
+bool Not::Compile(vm::Compiler& compiler) const {
+    if (!compiler.CompileNode(*argument_)) {
+        return false;
+    }
+    compiler.Emit(vm::OpCode::Not);
+    return true;
+}
+
 ObjectHolder Not::Execute(Closure& closure, Context& context) {
     ObjectHolder oh = argument_.get()->Execute(closure, context);
     if (auto* b = oh.TryAs<runtime::Bool>()) {
-        runtime::Bool result(!b->GetValue());
-        return ObjectHolder::Own(move(result));
+        return ObjectHolder::FromBool(!b->GetValue());
     }
     throw runtime_error(string(__func__) + " is failed");
 }
 
 //-----------------------------------------------------------------------------
 
+bool Compound::Compile(vm::Compiler& compiler) const {
+    // каждая инструкция оставляет на стеке одно значение, которое
+    // составной инструкции не нужно - снимаем его
+    for (const auto& st : statements_) {
+        if (!compiler.CompileNode(*st)) {
+            return false;
+        }
+        compiler.Emit(vm::OpCode::Pop);
+    }
+    compiler.Emit(vm::OpCode::LoadNone);
+    return true;
+}
+
 ObjectHolder Compound::Execute(Closure& closure, Context& context) {
     for (const auto& st : statements_) {
+        MYTHON_PROFILE_LINE(st->GetSourceLine());
         st.get()->Execute(closure, context);
     }
     return ObjectHolder::None();
@@ -385,6 +575,30 @@ IfElse::IfElse(std::unique_ptr<Statement> condition,
     condition_(move(condition)),
     if_body_(move(if_body)),
     else_body_(move(else_body)) {
+    // значение условия только проверяется на истинность
+    MarkIfVariableRead(condition_.get());
+}
+
+bool IfElse::Compile(vm::Compiler& compiler) const {
+    if (!compiler.CompileNode(*condition_)) {
+        return false;
+    }
+    size_t jump_to_else = compiler.EmitJump(vm::OpCode::JumpIfFalse);
+    if (!compiler.CompileNode(*if_body_)) {
+        return false;
+    }
+    size_t jump_to_end = compiler.EmitJump(vm::OpCode::Jump);
+    compiler.PatchJump(jump_to_else);
+    if (else_body_.get()) {
+        if (!compiler.CompileNode(*else_body_)) {
+            return false;
+        }
+    }
+    else {
+        compiler.Emit(vm::OpCode::LoadNone);
+    }
+    compiler.PatchJump(jump_to_end);
+    return true;
 }
 
 ObjectHolder IfElse::Execute(Closure& closure, Context& context) {
@@ -405,6 +619,47 @@ ObjectHolder IfElse::Execute(Closure& closure, Context& context) {
 
 //-----------------------------------------------------------------------------
 
+While::While(std::unique_ptr<Statement> condition, std::unique_ptr<Statement> body) :
+    condition_(move(condition)),
+    body_(move(body)) {
+    // значение условия только проверяется на истинность
+    MarkIfVariableRead(condition_.get());
+}
+
+bool While::Compile(vm::Compiler& compiler) const {
+    size_t loop_start = compiler.Position();
+    if (!compiler.CompileNode(*condition_)) {
+        return false;
+    }
+    size_t jump_to_exit = compiler.EmitJump(vm::OpCode::JumpIfFalse);
+    if (!compiler.CompileNode(*body_)) {
+        return false;
+    }
+    // значение тела не используется - снимаем его и возвращаемся к условию
+    compiler.Emit(vm::OpCode::Pop);
+    compiler.Emit(vm::OpCode::Jump, static_cast<uint32_t>(loop_start));
+    compiler.PatchJump(jump_to_exit);
+    compiler.Emit(vm::OpCode::LoadNone);
+    return true;
+}
+
+ObjectHolder While::Execute(Closure& closure, Context& context) {
+    while (true) {
+        ObjectHolder condition = condition_.get()->Execute(closure, context);
+        auto* b = condition.TryAs<runtime::Bool>();
+        if (nullptr == b) {
+            throw runtime_error(string(__func__) + " is failed");
+        }
+        if (!b->GetValue()) {
+            break;
+        }
+        body_->Execute(closure, context);
+    }
+    return ObjectHolder::None();
+}
+
+//-----------------------------------------------------------------------------
+
 Comparison::Comparison(Comparator cmp,
                        unique_ptr<Statement> lhs,
                        unique_ptr<Statement> rhs) :
@@ -412,11 +667,47 @@ Comparison::Comparison(Comparator cmp,
     cmp_(move(cmp)) {
 }
 
+bool Comparison::Compile(vm::Compiler& compiler) const {
+    // восстанавливаем код операции по функции сравнения:
+    // парсер передаёт сюда указатели на функции из runtime
+    using CmpPtr = bool (*)(const ObjectHolder&, const ObjectHolder&, runtime::Context&);
+    const CmpPtr* target = cmp_.target<CmpPtr>();
+    if (nullptr == target) {
+        return false;
+    }
+    vm::OpCode op;
+    if (*target == runtime::Equal) {
+        op = vm::OpCode::CmpEq;
+    }
+    else if (*target == runtime::NotEqual) {
+        op = vm::OpCode::CmpNotEq;
+    }
+    else if (*target == runtime::Less) {
+        op = vm::OpCode::CmpLess;
+    }
+    else if (*target == runtime::Greater) {
+        op = vm::OpCode::CmpGreater;
+    }
+    else if (*target == runtime::LessOrEqual) {
+        op = vm::OpCode::CmpLessEq;
+    }
+    else if (*target == runtime::GreaterOrEqual) {
+        op = vm::OpCode::CmpGreaterEq;
+    }
+    else {
+        return false;
+    }
+    if (!compiler.CompileNode(*lhs_) || !compiler.CompileNode(*rhs_)) {
+        return false;
+    }
+    compiler.Emit(op);
+    return true;
+}
+
 ObjectHolder Comparison::Execute(Closure& closure, Context& context) {
     ObjectHolder lhs_oh = lhs_.get()->Execute(closure, context);
     ObjectHolder rhs_oh = rhs_.get()->Execute(closure, context);
-    runtime::Bool result(cmp_(lhs_oh, rhs_oh, context));
-    return ObjectHolder::Own(move(result));
+    return ObjectHolder::FromBool(cmp_(lhs_oh, rhs_oh, context));
 }
 
 //-----------------------------------------------------------------------------
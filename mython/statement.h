@@ -1,345 +1,634 @@
-#pragma once
-
-#include "runtime.h"
-
-#include <functional>
-
-namespace ast {
-
-using Statement = runtime::Executable;
-
-// Выражение, возвращающее значение типа T,
-// используется как основа для создания констант
-template <typename T>
-class ValueStatement : public Statement {
-public:
-    explicit ValueStatement(T v)
-        : value_(std::move(v)) {
-    }
-
-    runtime::ObjectHolder Execute(runtime::Closure& /*closure*/,
-                                  runtime::Context& /*context*/) override {
-        return runtime::ObjectHolder::Share(value_);
-    }
-
-private:
-    T value_;
-};
-
-using NumericConst = ValueStatement<runtime::Number>;
-using StringConst = ValueStatement<runtime::String>;
-using BoolConst = ValueStatement<runtime::Bool>;
-
-/*
-Вычисляет значение переменной либо цепочки вызовов полей объектов id1.id2.id3.
-Например, выражение circle.center.x - цепочка вызовов полей объектов в инструкции:
-x = circle.center.x
-*/
-class VariableValue : public Statement {
-public:
-    explicit VariableValue(const std::string& var_name);
-    explicit VariableValue(std::vector<std::string> dotted_ids);
-
-    runtime::ObjectHolder Execute(runtime::Closure& closure,
-                                  [[maybe_unused]] runtime::Context& context) override;
-
-private:
-    std::vector<std::string> dotted_ids_;
-};
-
-// Присваивает переменной, имя которой задано в параметре var, значение выражения rv
-class Assignment : public Statement {
-public:
-    Assignment(std::string var, std::unique_ptr<Statement> rv);
-
-    runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
-
-private:
-    std::string var_;
-    std::unique_ptr<Statement> rv_;
-};
-
-// Присваивает полю object.field_name значение выражения rv
-class FieldAssignment : public Statement {
-public:
-    FieldAssignment(VariableValue object, std::string field_name, std::unique_ptr<Statement> rv);
-
-    runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
-
-private:
-    VariableValue object_;
-    std::string field_name_;
-    std::unique_ptr<Statement> rv_;
-};
-
-// Значение None
-class None : public Statement {
-public:
-    runtime::ObjectHolder Execute([[maybe_unused]] runtime::Closure& closure,
-                                  [[maybe_unused]] runtime::Context& context) override;
-};
-
-// Команда print
-class Print : public Statement {
-public:
-    // Инициализирует команду print для вывода значения выражения argument
-    explicit Print(std::unique_ptr<Statement> argument);
-    // Инициализирует команду print для вывода списка значений args
-    explicit Print(std::vector<std::unique_ptr<Statement>> args);
-
-    // Инициализирует команду print для вывода значения переменной name
-    static std::unique_ptr<Print> Variable(const std::string& name);
-
-    // Во время выполнения команды print вывод должен осуществляться в поток, возвращаемый из
-    // context.GetOutputStream()
-    runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
-
-private:
-    std::vector<std::unique_ptr<Statement>> args_;
-};
-
-// Вызывает метод object.method со списком параметров args
-class MethodCall : public Statement {
-public:
-    MethodCall(std::unique_ptr<Statement> object, std::string method,
-               std::vector<std::unique_ptr<Statement>> args);
-
-    runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
-
-private:
-    std::unique_ptr<Statement> object_;
-    std::string method_;
-    std::vector<std::unique_ptr<Statement>> args_;
-};
-
-/*
-Создаёт новый экземпляр класса class_, передавая его конструктору набор параметров args.
-Если в классе отсутствует метод __init__ с заданным количеством аргументов,
-то экземпляр класса создаётся без вызова конструктора (поля объекта не будут проинициализированы):
-
-class Person:
-  def set_name(name):
-    self.name = name
-
-p = Person()
-# Поле name будет иметь значение только после вызова метода set_name
-p.set_name("Ivan")
-*/
-class NewInstance : public Statement {
-public:
-    explicit NewInstance(const runtime::Class& class_);
-    NewInstance(const runtime::Class& class_, std::vector<std::unique_ptr<Statement>> args);
-    // Возвращает объект, содержащий значение типа ClassInstance
-    runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
-
-private:
-    runtime::ClassInstance ci_;
-    std::vector<std::unique_ptr<Statement>> args_;
-};
-
-// Базовый класс для унарных операций
-class UnaryOperation : public Statement {
-public:
-    explicit UnaryOperation(std::unique_ptr<Statement> argument);
-
-protected:
-    std::unique_ptr<Statement> argument_;
-};
-
-// Операция str, возвращающая строковое значение своего аргумента
-class Stringify : public UnaryOperation {
-public:
-    using UnaryOperation::UnaryOperation;
-    runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
-};
-
-// Родительский класс Бинарная операция с аргументами lhs и rhs
-class BinaryOperation : public Statement {
-public:
-    BinaryOperation(std::unique_ptr<Statement> lhs, std::unique_ptr<Statement> rhs);
-
-protected:
-    std::unique_ptr<Statement> lhs_;
-    std::unique_ptr<Statement> rhs_;
-};
-
-// Возвращает результат операции + над аргументами lhs и rhs
-class Add : public BinaryOperation {
-public:
-    using BinaryOperation::BinaryOperation;
-
-    // Поддерживается сложение:
-    //  число + число
-    //  строка + строка
-    //  объект1 + объект2, если у объект1 - пользовательский класс с методом _add__(rhs)
-    // В противном случае при вычислении выбрасывается runtime_error
-    runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
-};
-
-// Возвращает результат вычитания аргументов lhs и rhs
-class Sub : public BinaryOperation {
-public:
-    using BinaryOperation::BinaryOperation;
-
-    // Поддерживается вычитание:
-    //  число - число
-    // Если lhs и rhs - не числа, выбрасывается исключение runtime_error
-    runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
-};
-
-// Возвращает результат умножения аргументов lhs и rhs
-class Mult : public BinaryOperation {
-public:
-    using BinaryOperation::BinaryOperation;
-
-    // Поддерживается умножение:
-    //  число * число
-    // Если lhs и rhs - не числа, выбрасывается исключение runtime_error
-    runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
-};
-
-// Возвращает результат деления lhs и rhs
-class Div : public BinaryOperation {
-public:
-    using BinaryOperation::BinaryOperation;
-
-    // Поддерживается деление:
-    //  число / число
-    // Если lhs и rhs - не числа, выбрасывается исключение runtime_error
-    // Если rhs равен 0, выбрасывается исключение runtime_error
-    runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
-};
-
-// Возвращает результат вычисления логической операции or над lhs и rhs
-class Or : public BinaryOperation {
-public:
-    using BinaryOperation::BinaryOperation;
-    // Значение аргумента rhs вычисляется, только если значение lhs
-    // после приведения к Bool равно False
-    runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
-};
-
-// Возвращает результат вычисления логической операции and над lhs и rhs
-class And : public BinaryOperation {
-public:
-    using BinaryOperation::BinaryOperation;
-    // Значение аргумента rhs вычисляется, только если значение lhs
-    // после приведения к Bool равно True
-    runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
-};
-
-// Возвращает результат вычисления логической операции not над единственным аргументом операции
-class Not : public UnaryOperation {
-public:
-    using UnaryOperation::UnaryOperation;
-    runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
-};
-
-// Составная инструкция (например: тело метода, содержимое ветки if, либо else)
-class Compound : public Statement {
-public:
-    void Parser() {}
-
-    template<typename T>
-    void Parser(T&& arg) {
-        statements_.push_back(move(arg));
-    }
-
-    template <typename First, typename... Rest> 
-    void Parser(First&& first, Rest&&... rest) {
-        statements_.push_back(move(first));
-        Parser(rest...);
-    }
-
-    // Конструирует Compound из нескольких инструкций типа unique_ptr<Statement>
-    template <typename... Args>
-    explicit Compound(Args&&... args) {
-        Parser(args...);
-    }
-
-    // Добавляет очередную инструкцию в конец составной инструкции
-    void AddStatement(std::unique_ptr<Statement> stmt) {
-        statements_.push_back(std::move(stmt));
-    }
-
-    // Последовательно выполняет добавленные инструкции. Возвращает None
-    runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
-
-private:
-    std::vector<std::unique_ptr<Statement>> statements_;
-};
-
-// Тело метода. Как правило, содержит составную инструкцию
-class MethodBody : public Statement {
-public:
-    explicit MethodBody(std::unique_ptr<Statement>&& body);
-
-    // Вычисляет инструкцию, переданную в качестве body.
-    // Если внутри body была выполнена инструкция return, возвращает результат return
-    // В противном случае возвращает None
-    runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
-
-private:
-    std::unique_ptr<Statement> body_;
-};
-
-// Выполняет инструкцию return с выражением statement
-class Return : public Statement {
-public:
-    explicit Return(std::unique_ptr<Statement> statement);
-
-    // Останавливает выполнение текущего метода. После выполнения инструкции return метод,
-    // внутри которого она была исполнена, должен вернуть результат вычисления выражения statement.
-    runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
-
-private:
-    std::unique_ptr<Statement> statement_;
-};
-
-// Объявляет класс
-class ClassDefinition : public Statement {
-public:
-    // Гарантируется, что ObjectHolder содержит объект типа runtime::Class
-    explicit ClassDefinition(runtime::ObjectHolder cls);
-
-    // Создаёт внутри closure новый объект, совпадающий с именем класса и значением, переданным в
-    // конструктор
-    runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
-
-private:
-    runtime::ObjectHolder cls_;
-};
-
-// Инструкция if <condition> <if_body> else <else_body>
-class IfElse : public Statement {
-public:
-    // Параметр else_body может быть равен nullptr
-    IfElse(std::unique_ptr<Statement> condition, std::unique_ptr<Statement> if_body,
-           std::unique_ptr<Statement> else_body);
-
-    runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
-
-private:
-    std::unique_ptr<Statement> condition_;
-    std::unique_ptr<Statement> if_body_;
-    std::unique_ptr<Statement> else_body_;
-};
-
-// Операция сравнения
-class Comparison : public BinaryOperation {
-public:
-    // Comparator задаёт функцию, выполняющую сравнение значений аргументов
-    using Comparator = std::function<bool(const runtime::ObjectHolder&,
-                                          const runtime::ObjectHolder&, runtime::Context&)>;
-
-    Comparison(Comparator cmp, std::unique_ptr<Statement> lhs, std::unique_ptr<Statement> rhs);
-
-    // Вычисляет значение выражений lhs и rhs и возвращает результат работы comparator,
-    // приведённый к типу runtime::Bool
-    runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
-
-private:
-    Comparator cmp_;
-};
-
+#pragma once
+
+#include "runtime.h"
+#include "vm.h"
+
+#include <atomic>
+
+#include <functional>
+
+namespace ast {
+
+using Statement = runtime::Executable;
+
+namespace detail {
+
+/*
+ * Потокобезопасный кеш места обращения в узле AST. Хранит указатель на
+ * неизменяемую запись Entry (Entry обязан иметь поле next); обновление
+ * публикует новую запись атомарно, а вытесненные записи остаются в цепочке
+ * до разрушения узла, поэтому читатели из других потоков всегда видят
+ * целиком согласованную запись. После MEGAMORPHIC_THRESHOLD публикаций
+ * место признаётся мегаморфным и больше не публикует: цепочка
+ * вытесненных записей ограничена, а вызывающий код откатывается
+ * на некешированный поиск. Одно дерево программы может выполняться
+ * одновременно из нескольких потоков (см. CompiledProgram)
+ */
+template <typename Entry>
+class SiteCache {
+public:
+    SiteCache() = default;
+    SiteCache(const SiteCache&) = delete;
+    SiteCache& operator=(const SiteCache&) = delete;
+
+    ~SiteCache() {
+        Entry* entry = head_.load(std::memory_order_relaxed);
+        while (nullptr != entry) {
+            Entry* next = entry->next;
+            delete entry;
+            entry = next;
+        }
+    }
+
+    // Возвращает последнюю опубликованную запись либо nullptr
+    const Entry* Get() const {
+        return head_.load(std::memory_order_acquire);
+    }
+
+    // Публикует новую запись; на мегаморфном месте публикация
+    // пропускается, и кеш замирает на последней записи
+    void Update(Entry entry) {
+        if (publish_count_.load(std::memory_order_relaxed) >= MEGAMORPHIC_THRESHOLD) {
+            return;
+        }
+        publish_count_.fetch_add(1, std::memory_order_relaxed);
+        Entry* published = new Entry(std::move(entry));
+        published->next = head_.load(std::memory_order_relaxed);
+        while (!head_.compare_exchange_weak(published->next, published,
+                                            std::memory_order_release,
+                                            std::memory_order_relaxed)) {
+        }
+    }
+
+private:
+    // после стольких промахов с публикацией место считается мегаморфным
+    static constexpr uint32_t MEGAMORPHIC_THRESHOLD = 8;
+
+    std::atomic<Entry*> head_{nullptr};
+    std::atomic<uint32_t> publish_count_{0};
+};
+
+/*
+ * Накопитель профиля типов арифметического узла. Узел наблюдает типы
+ * операндов первые SPECIALIZE_THRESHOLD выполнений; если все они int+int,
+ * он переключается на целочисленный быстрый путь с охранной проверкой,
+ * а при несовпадении типов деоптимизируется обратно в общий путь
+ * навсегда. Состояние атомарное: гонки при одновременном выполнении
+ * из нескольких потоков лишь задерживают специализацию, но не ломают её
+ */
+class TypeFeedback {
+public:
+    // узел специализирован под int+int
+    [[nodiscard]] bool IsIntSpecialized() const {
+        return state_.load(std::memory_order_relaxed) == INT_FAST;
+    }
+
+    // наблюдение int+int; после порога включает быстрый путь
+    void ObserveIntInt() {
+        if (state_.load(std::memory_order_relaxed) != OBSERVING) {
+            return;
+        }
+        if (hits_.fetch_add(1, std::memory_order_relaxed) + 1 >= SPECIALIZE_THRESHOLD) {
+            state_.store(INT_FAST, std::memory_order_relaxed);
+        }
+    }
+
+    // наблюдение других типов либо провал охранной проверки:
+    // узел остаётся на общем пути
+    void Deoptimize() {
+        state_.store(GENERIC, std::memory_order_relaxed);
+    }
+
+private:
+    enum State : uint8_t {
+        OBSERVING,  // накапливаем наблюдения
+        INT_FAST,   // целочисленный быстрый путь
+        GENERIC,    // общий путь без дальнейших наблюдений
+    };
+
+    static constexpr uint8_t SPECIALIZE_THRESHOLD = 8;
+
+    std::atomic<uint8_t> state_{OBSERVING};
+    std::atomic<uint8_t> hits_{0};
+};
+
+}  // namespace detail
+
+// Выражение, возвращающее значение типа T,
+// используется как основа для создания констант
+template <typename T>
+class ValueStatement : public Statement {
+public:
+    explicit ValueStatement(T v)
+        : value_(std::move(v)) {
+    }
+
+    runtime::ObjectHolder Execute(runtime::Closure& /*closure*/,
+                                  runtime::Context& /*context*/) override {
+        return runtime::ObjectHolder::Share(value_);
+    }
+
+    bool Compile(vm::Compiler& compiler) const override {
+        // константа попадает в пул констант байт-кода
+        compiler.Emit(vm::OpCode::Const,
+                      compiler.AddConstant(runtime::ObjectHolder::Own(T(value_))));
+        return true;
+    }
+
+private:
+    T value_;
+};
+
+using NumericConst = ValueStatement<runtime::Number>;
+using StringConst = ValueStatement<runtime::String>;
+using BoolConst = ValueStatement<runtime::Bool>;
+
+/*
+Вычисляет значение переменной либо цепочки вызовов полей объектов id1.id2.id3.
+Например, выражение circle.center.x - цепочка вызовов полей объектов в инструкции:
+x = circle.center.x
+*/
+class VariableValue : public Statement {
+public:
+    explicit VariableValue(const std::string& var_name);
+    explicit VariableValue(std::vector<std::string> dotted_ids);
+
+    runtime::ObjectHolder Execute(runtime::Closure& closure,
+                                  [[maybe_unused]] runtime::Context& context) override;
+
+    bool Compile(vm::Compiler& compiler) const override;
+
+    /*
+     * Помечает чтение как неубегающее: владелец узла гарантирует, что
+     * значение только читается и не переживает Execute объемлющей
+     * инструкции (условия if/while, аргументы print). Только такие
+     * чтения вправе возвращать заимствованный холдер в сессионном
+     * режиме (см. runtime::ExecutionSession)
+     */
+    void MarkNonEscapingRead() {
+        borrow_ok_ = true;
+    }
+
+private:
+    // кеш слота одного звена цепочки: при совпадении формы таблицы
+    // индекс слота берётся из кеша без поиска по имени
+    struct SlotCacheEntry {
+        const runtime::Shape* shape = nullptr;
+        int slot = -1;
+        SlotCacheEntry* next = nullptr;
+    };
+
+    // интернированная цепочка идентификаторов id1.id2.id3
+    std::vector<runtime::Symbol> dotted_ids_;
+    // чтение доказуемо не убегает - можно заимствовать значение слота
+    bool borrow_ok_ = false;
+    // кеши слотов по звеньям цепочки
+    std::vector<detail::SiteCache<SlotCacheEntry>> slot_caches_;
+};
+
+// Присваивает переменной, имя которой задано в параметре var, значение выражения rv
+class Assignment : public Statement {
+public:
+    Assignment(std::string var, std::unique_ptr<Statement> rv);
+
+    runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+    bool Compile(vm::Compiler& compiler) const override;
+
+private:
+    runtime::Symbol var_;
+    std::unique_ptr<Statement> rv_;
+};
+
+// Присваивает полю object.field_name значение выражения rv
+class FieldAssignment : public Statement {
+public:
+    FieldAssignment(VariableValue object, std::string field_name, std::unique_ptr<Statement> rv);
+
+    runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+private:
+    VariableValue object_;
+    runtime::Symbol field_name_;
+    std::unique_ptr<Statement> rv_;
+};
+
+// Значение None
+class None : public Statement {
+public:
+    runtime::ObjectHolder Execute([[maybe_unused]] runtime::Closure& closure,
+                                  [[maybe_unused]] runtime::Context& context) override;
+
+    bool Compile(vm::Compiler& compiler) const override;
+};
+
+// Команда print
+class Print : public Statement {
+public:
+    // Инициализирует команду print для вывода значения выражения argument
+    explicit Print(std::unique_ptr<Statement> argument);
+    // Инициализирует команду print для вывода списка значений args
+    explicit Print(std::vector<std::unique_ptr<Statement>> args);
+
+    // Инициализирует команду print для вывода значения переменной name
+    static std::unique_ptr<Print> Variable(const std::string& name);
+
+    // Во время выполнения команды print вывод должен осуществляться в поток, возвращаемый из
+    // context.GetOutputStream()
+    runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+    bool Compile(vm::Compiler& compiler) const override;
+
+private:
+    std::vector<std::unique_ptr<Statement>> args_;
+};
+
+// Вызывает метод object.method со списком параметров args
+class MethodCall : public Statement {
+public:
+    MethodCall(std::unique_ptr<Statement> object, std::string method,
+               std::vector<std::unique_ptr<Statement>> args);
+
+    runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+private:
+    std::unique_ptr<Statement> object_;
+    std::string method_;
+    std::vector<std::unique_ptr<Statement>> args_;
+
+    // inline-кеш места вызова: метод почти всегда ищется в одном и том же
+    // классе, поэтому запоминаем результат последнего поиска
+    struct CallCacheEntry {
+        const runtime::Class* cls = nullptr;
+        const runtime::Method* method = nullptr;
+        CallCacheEntry* next = nullptr;
+    };
+
+    detail::SiteCache<CallCacheEntry> call_cache_;
+};
+
+/*
+Создаёт новый экземпляр класса class_, передавая его конструктору набор параметров args.
+Если в классе отсутствует метод __init__ с заданным количеством аргументов,
+то экземпляр класса создаётся без вызова конструктора (поля объекта не будут проинициализированы):
+
+class Person:
+  def set_name(name):
+    self.name = name
+
+p = Person()
+# Поле name будет иметь значение только после вызова метода set_name
+p.set_name("Ivan")
+*/
+class NewInstance : public Statement {
+public:
+    explicit NewInstance(const runtime::Class& class_);
+    NewInstance(const runtime::Class& class_, std::vector<std::unique_ptr<Statement>> args);
+    // Возвращает объект, содержащий значение типа ClassInstance
+    runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+private:
+    const runtime::Class& class_;
+    std::vector<std::unique_ptr<Statement>> args_;
+};
+
+// Базовый класс для унарных операций
+class UnaryOperation : public Statement {
+public:
+    explicit UnaryOperation(std::unique_ptr<Statement> argument);
+
+protected:
+    std::unique_ptr<Statement> argument_;
+};
+
+// Операция str, возвращающая строковое значение своего аргумента
+class Stringify : public UnaryOperation {
+public:
+    using UnaryOperation::UnaryOperation;
+    runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+};
+
+// Родительский класс Бинарная операция с аргументами lhs и rhs
+class BinaryOperation : public Statement {
+public:
+    BinaryOperation(std::unique_ptr<Statement> lhs, std::unique_ptr<Statement> rhs);
+
+protected:
+    std::unique_ptr<Statement> lhs_;
+    std::unique_ptr<Statement> rhs_;
+};
+
+// Возвращает результат операции + над аргументами lhs и rhs
+class Add : public BinaryOperation {
+public:
+    using BinaryOperation::BinaryOperation;
+
+    // Поддерживается сложение:
+    //  число + число
+    //  строка + строка
+    //  объект1 + объект2, если у объект1 - пользовательский класс с методом _add__(rhs)
+    // В противном случае при вычислении выбрасывается runtime_error
+    runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+    bool Compile(vm::Compiler& compiler) const override;
+
+private:
+    // профиль типов операндов этого места сложения
+    detail::TypeFeedback feedback_;
+};
+
+// Возвращает результат вычитания аргументов lhs и rhs
+class Sub : public BinaryOperation {
+public:
+    using BinaryOperation::BinaryOperation;
+
+    // Поддерживается вычитание:
+    //  число - число
+    // Если lhs и rhs - не числа, выбрасывается исключение runtime_error
+    runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+    bool Compile(vm::Compiler& compiler) const override;
+};
+
+// Возвращает результат умножения аргументов lhs и rhs
+class Mult : public BinaryOperation {
+public:
+    using BinaryOperation::BinaryOperation;
+
+    // Поддерживается умножение:
+    //  число * число
+    // Если lhs и rhs - не числа, выбрасывается исключение runtime_error
+    runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+    bool Compile(vm::Compiler& compiler) const override;
+};
+
+// Возвращает результат деления lhs и rhs
+class Div : public BinaryOperation {
+public:
+    using BinaryOperation::BinaryOperation;
+
+    // Поддерживается деление:
+    //  число / число
+    // Если lhs и rhs - не числа, выбрасывается исключение runtime_error
+    // Если rhs равен 0, выбрасывается исключение runtime_error
+    runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+    bool Compile(vm::Compiler& compiler) const override;
+};
+
+// Возвращает результат вычисления логической операции or над lhs и rhs
+class Or : public BinaryOperation {
+public:
+    using BinaryOperation::BinaryOperation;
+    // Значение аргумента rhs вычисляется, только если значение lhs
+    // после приведения к Bool равно False
+    runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+    bool Compile(vm::Compiler& compiler) const override;
+};
+
+// Возвращает результат вычисления логической операции and над lhs и rhs
+class And : public BinaryOperation {
+public:
+    using BinaryOperation::BinaryOperation;
+    // Значение аргумента rhs вычисляется, только если значение lhs
+    // после приведения к Bool равно True
+    runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+    bool Compile(vm::Compiler& compiler) const override;
+};
+
+// Возвращает результат вычисления логической операции not над единственным аргументом операции
+class Not : public UnaryOperation {
+public:
+    using UnaryOperation::UnaryOperation;
+    runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+    bool Compile(vm::Compiler& compiler) const override;
+};
+
+// Составная инструкция (например: тело метода, содержимое ветки if, либо else)
+class Compound : public Statement {
+public:
+    void Parser() {}
+
+    template<typename T>
+    void Parser(T&& arg) {
+        AddStatement(move(arg));
+    }
+
+    template <typename First, typename... Rest> 
+    void Parser(First&& first, Rest&&... rest) {
+        AddStatement(move(first));
+        Parser(rest...);
+    }
+
+    // Конструирует Compound из нескольких инструкций типа unique_ptr<Statement>
+    template <typename... Args>
+    explicit Compound(Args&&... args) {
+        Parser(args...);
+    }
+
+    // Добавляет очередную инструкцию в конец составной инструкции.
+    // Результат инструкции в этой позиции отбрасывается - узел может
+    // не материализовывать его (см. Executable::MarkResultDiscarded)
+    void AddStatement(std::unique_ptr<Statement> stmt) {
+        stmt->MarkResultDiscarded();
+        statements_.push_back(std::move(stmt));
+    }
+
+    // Последовательно выполняет добавленные инструкции. Возвращает None
+    runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+    bool Compile(vm::Compiler& compiler) const override;
+
+private:
+    std::vector<std::unique_ptr<Statement>> statements_;
+};
+
+// Тело метода. Как правило, содержит составную инструкцию
+class MethodBody : public Statement {
+public:
+    explicit MethodBody(std::unique_ptr<Statement>&& body);
+
+    // Вычисляет инструкцию, переданную в качестве body.
+    // Если внутри body была выполнена инструкция return, возвращает результат return
+    // В противном случае возвращает None
+    runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+private:
+    std::unique_ptr<Statement> body_;
+};
+
+// Выполняет инструкцию return с выражением statement
+class Return : public Statement {
+public:
+    explicit Return(std::unique_ptr<Statement> statement);
+
+    // Останавливает выполнение текущего метода. После выполнения инструкции return метод,
+    // внутри которого она была исполнена, должен вернуть результат вычисления выражения statement.
+    runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+private:
+    std::unique_ptr<Statement> statement_;
+};
+
+// Объявляет класс
+class ClassDefinition : public Statement {
+public:
+    // Гарантируется, что ObjectHolder содержит объект типа runtime::Class
+    explicit ClassDefinition(runtime::ObjectHolder cls);
+
+    // Создаёт внутри closure новый объект, совпадающий с именем класса и значением, переданным в
+    // конструктор
+    runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+private:
+    runtime::ObjectHolder cls_;
+};
+
+// Инструкция if <condition> <if_body> else <else_body>
+class IfElse : public Statement {
+public:
+    // Параметр else_body может быть равен nullptr
+    IfElse(std::unique_ptr<Statement> condition, std::unique_ptr<Statement> if_body,
+           std::unique_ptr<Statement> else_body);
+
+    runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+    bool Compile(vm::Compiler& compiler) const override;
+
+private:
+    std::unique_ptr<Statement> condition_;
+    std::unique_ptr<Statement> if_body_;
+    std::unique_ptr<Statement> else_body_;
+};
+
+// Цикл while с условием condition и телом body
+class While : public Statement {
+public:
+    While(std::unique_ptr<Statement> condition, std::unique_ptr<Statement> body);
+
+    /*
+     * Выполняет тело, пока условие возвращает Bool со значением True.
+     * Итерации идут плоским циклом в текущем кадре - без рекурсии,
+     * без построения замыкания и без роста стека C++ на каждую итерацию
+     */
+    runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+    bool Compile(vm::Compiler& compiler) const override;
+
+private:
+    std::unique_ptr<Statement> condition_;
+    std::unique_ptr<Statement> body_;
+};
+
+// Операция сравнения
+class Comparison : public BinaryOperation {
+public:
+    // Comparator задаёт функцию, выполняющую сравнение значений аргументов
+    using Comparator = std::function<bool(const runtime::ObjectHolder&,
+                                          const runtime::ObjectHolder&, runtime::Context&)>;
+
+    Comparison(Comparator cmp, std::unique_ptr<Statement> lhs, std::unique_ptr<Statement> rhs);
+
+    // Вычисляет значение выражений lhs и rhs и возвращает результат работы comparator,
+    // приведённый к типу runtime::Bool
+    runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+    bool Compile(vm::Compiler& compiler) const override;
+
+private:
+    Comparator cmp_;
+};
+
+namespace detail {
+
+// Статические описания операций сравнения: функция сравнения объектов,
+// её быстрый вариант для пары чисел и код операции байт-кода
+struct EqualOp {
+    static constexpr auto Generic = &runtime::Equal;
+    static constexpr vm::OpCode kOpCode = vm::OpCode::CmpEq;
+    static bool Fast(int lhs, int rhs) {
+        return lhs == rhs;
+    }
+};
+
+struct NotEqualOp {
+    static constexpr auto Generic = &runtime::NotEqual;
+    static constexpr vm::OpCode kOpCode = vm::OpCode::CmpNotEq;
+    static bool Fast(int lhs, int rhs) {
+        return lhs != rhs;
+    }
+};
+
+struct LessOp {
+    static constexpr auto Generic = &runtime::Less;
+    static constexpr vm::OpCode kOpCode = vm::OpCode::CmpLess;
+    static bool Fast(int lhs, int rhs) {
+        return lhs < rhs;
+    }
+};
+
+struct GreaterOp {
+    static constexpr auto Generic = &runtime::Greater;
+    static constexpr vm::OpCode kOpCode = vm::OpCode::CmpGreater;
+    static bool Fast(int lhs, int rhs) {
+        return lhs > rhs;
+    }
+};
+
+struct LessOrEqualOp {
+    static constexpr auto Generic = &runtime::LessOrEqual;
+    static constexpr vm::OpCode kOpCode = vm::OpCode::CmpLessEq;
+    static bool Fast(int lhs, int rhs) {
+        return lhs <= rhs;
+    }
+};
+
+struct GreaterOrEqualOp {
+    static constexpr auto Generic = &runtime::GreaterOrEqual;
+    static constexpr vm::OpCode kOpCode = vm::OpCode::CmpGreaterEq;
+    static bool Fast(int lhs, int rhs) {
+        return lhs >= rhs;
+    }
+};
+
+}  // namespace detail
+
+/*
+ * Сравнение с известной на этапе компиляции операцией Op (см. ast::detail).
+ * В отличие от ast::Comparison вызов функции сравнения прямой, без обёртки
+ * std::function, а пара чисел сравнивается по значениям, минуя разбор типов
+ * в runtime::Less/Equal. Создаётся парсером; ast::Comparison сохранён для
+ * сравнения произвольной функцией
+ */
+template <typename Op>
+class StaticComparison : public BinaryOperation {
+public:
+    using BinaryOperation::BinaryOperation;
+
+    runtime::ObjectHolder Execute(runtime::Closure& closure,
+                                  runtime::Context& context) override {
+        runtime::ObjectHolder lhs_oh = lhs_.get()->Execute(closure, context);
+        runtime::ObjectHolder rhs_oh = rhs_.get()->Execute(closure, context);
+        if (const auto* lhs_num = lhs_oh.TryAs<runtime::Number>()) {
+            if (const auto* rhs_num = rhs_oh.TryAs<runtime::Number>()) {
+                return runtime::ObjectHolder::FromBool(
+                    Op::Fast(lhs_num->GetValue(), rhs_num->GetValue()));
+            }
+        }
+        return runtime::ObjectHolder::FromBool(Op::Generic(lhs_oh, rhs_oh, context));
+    }
+
+    bool Compile(vm::Compiler& compiler) const override {
+        if (!compiler.CompileNode(*lhs_) || !compiler.CompileNode(*rhs_)) {
+            return false;
+        }
+        compiler.Emit(Op::kOpCode);
+        return true;
+    }
+};
+
 }  // namespace ast
\ No newline at end of file
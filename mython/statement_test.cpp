@@ -172,6 +172,19 @@ void TestPrintMultipleStatements() {
     ASSERT_EQUAL(context.output.str(), "hello 57 Python None\n"s);
 }
 
+void TestPrintBuffered() {
+    ostringstream out;
+    runtime::BufferedContext context(out, 64);
+
+    Closure closure = {{"y"s, ObjectHolder::Own(runtime::Number(42))}};
+    Print::Variable("y"s)->Execute(closure, context);
+
+    // print не сбрасывает буфер контекста - вывод уходит только по Flush
+    ASSERT_EQUAL(out.str(), ""s);
+    context.Flush();
+    ASSERT_EQUAL(out.str(), "42\n"s);
+}
+
 void TestStringify() {
     runtime::DummyContext context;
 
@@ -463,6 +476,7 @@ void RunUnitTests(TestRunner& tr) {
     RUN_TEST(tr, ast::TestFieldAssignment);
     RUN_TEST(tr, ast::TestPrintVariable);
     RUN_TEST(tr, ast::TestPrintMultipleStatements);
+    RUN_TEST(tr, ast::TestPrintBuffered);
     RUN_TEST(tr, ast::TestStringify);
     RUN_TEST(tr, ast::TestNumbersAddition);
     RUN_TEST(tr, ast::TestStringsAddition);
@@ -0,0 +1,44 @@
+#include "symbol.h"
+
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+using namespace std;
+
+namespace runtime {
+
+namespace {
+
+// глобальная таблица интернированных строк
+struct SymbolTable {
+    mutex guard;
+    unordered_map<string, Symbol> ids;
+    // указатели на ключи ids стабильны, поэтому храним их для обратного поиска
+    deque<const string*> names;
+};
+
+SymbolTable& GetTable() {
+    static SymbolTable table;
+    return table;
+}
+
+}  // namespace
+
+Symbol Intern(const string& name) {
+    SymbolTable& table = GetTable();
+    lock_guard<mutex> lock(table.guard);
+    auto [it, inserted] = table.ids.emplace(name, static_cast<Symbol>(table.names.size()));
+    if (inserted) {
+        table.names.push_back(&it->first);
+    }
+    return it->second;
+}
+
+const string& SymbolName(Symbol symbol) {
+    SymbolTable& table = GetTable();
+    lock_guard<mutex> lock(table.guard);
+    return *table.names.at(symbol);
+}
+
+}  // namespace runtime
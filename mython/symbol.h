@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace runtime {
+
+// Идентификатор интернированной строки. Одинаковым строкам соответствует
+// один и тот же Symbol, поэтому сравнение и хеширование идентификаторов -
+// операции над целым числом, а не над строкой
+using Symbol = uint32_t;
+
+// Интернирует строку name и возвращает её идентификатор.
+// Идентификаторы выдаются плотно, начиная с нуля
+Symbol Intern(const std::string& name);
+
+// Возвращает строку, соответствующую идентификатору symbol
+const std::string& SymbolName(Symbol symbol);
+
+}  // namespace runtime
@@ -0,0 +1,433 @@
+#include "vm.h"
+
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+
+using namespace std;
+
+namespace vm {
+
+using runtime::ObjectHolder;
+
+optional<Chunk> Compiler::Compile(const runtime::Executable& program) {
+    Compiler compiler;
+    if (!program.Compile(compiler)) {
+        // программа содержит неподдерживаемые узлы -
+        // выполнять её нужно через Execute
+        return nullopt;
+    }
+    return std::move(compiler.chunk_);
+}
+
+void Compiler::Emit(OpCode op, uint32_t arg) {
+    chunk_.code_.push_back(Instruction{op, arg});
+}
+
+size_t Compiler::Position() const {
+    return chunk_.code_.size();
+}
+
+size_t Compiler::EmitJump(OpCode op) {
+    Emit(op);
+    return chunk_.code_.size() - 1;
+}
+
+void Compiler::PatchJump(size_t jump_pos) {
+    chunk_.code_[jump_pos].arg = static_cast<uint32_t>(chunk_.code_.size());
+}
+
+uint32_t Compiler::AddConstant(ObjectHolder value) {
+    chunk_.constants_.push_back(std::move(value));
+    return static_cast<uint32_t>(chunk_.constants_.size() - 1);
+}
+
+uint32_t Compiler::AddName(const std::string& name) {
+    // имена переменных повторяются часто - ищем существующее
+    for (size_t i = 0; i < chunk_.names_.size(); ++i) {
+        if (chunk_.names_[i] == name) {
+            return static_cast<uint32_t>(i);
+        }
+    }
+    chunk_.names_.push_back(name);
+    return static_cast<uint32_t>(chunk_.names_.size() - 1);
+}
+
+bool Compiler::CompileNode(const runtime::Executable& node) {
+    return node.Compile(*this);
+}
+
+namespace {
+
+// снимает со стека вершину
+ObjectHolder PopStack(vector<ObjectHolder>& stack) {
+    ObjectHolder result = std::move(stack.back());
+    stack.pop_back();
+    return result;
+}
+
+// сложение по правилам ast::Add
+ObjectHolder AddValues(const ObjectHolder& lhs, const ObjectHolder& rhs,
+                       runtime::Context& context) {
+    if (auto* lhs_n = lhs.TryAs<runtime::Number>()) {
+        if (auto* rhs_n = rhs.TryAs<runtime::Number>()) {
+            return ObjectHolder::FromInt(lhs_n->GetValue() + rhs_n->GetValue());
+        }
+    }
+    else if (auto* lhs_s = lhs.TryAs<runtime::String>()) {
+        if (auto* rhs_s = rhs.TryAs<runtime::String>()) {
+            if (lhs.IsUniquelyOwned()) {
+                // временная строка: дописываем на месте (см. ast::Add)
+                lhs_s->GetValue() += rhs_s->GetValue();
+                return lhs;
+            }
+            return ObjectHolder::Own(runtime::String(lhs_s->GetValue() + rhs_s->GetValue()));
+        }
+    }
+    else if (auto* lhs_ci = lhs.TryAs<runtime::ClassInstance>()) {
+        if (lhs_ci->HasMethod("__add__"s, 1)) {
+            return lhs_ci->Call("__add__"s, {rhs}, context);
+        }
+    }
+    throw runtime_error(string(__func__) + " is failed");
+}
+
+// логическое значение операнда по правилам ast::And/Or/Not
+bool BoolValue(const ObjectHolder& value) {
+    if (auto* b = value.TryAs<runtime::Bool>()) {
+        return b->GetValue();
+    }
+    throw runtime_error(string(__func__) + " is failed");
+}
+
+}  // namespace
+
+ObjectHolder Run(const Chunk& chunk, runtime::Closure& closure, runtime::Context& context) {
+    const vector<Instruction>& code = chunk.Code();
+    vector<ObjectHolder> stack;
+
+    size_t ip = 0;
+    while (ip < code.size()) {
+        const Instruction& insn = code[ip];
+        ++ip;
+
+        switch (insn.op) {
+        case OpCode::Const:
+            stack.push_back(chunk.Constants()[insn.arg]);
+            break;
+        case OpCode::LoadNone:
+            stack.push_back(ObjectHolder::None());
+            break;
+        case OpCode::LoadVar: {
+            const string& name = chunk.Names()[insn.arg];
+            if (0 == closure.count(name)) {
+                throw runtime_error("Undefined variable \"" + name + "\"");
+            }
+            stack.push_back(closure.at(name));
+            break;
+        }
+        case OpCode::StoreVar:
+            // присваивание оставляет значение на стеке, как Assignment::Execute
+            closure[chunk.Names()[insn.arg]] = stack.back();
+            break;
+        case OpCode::Add: {
+            ObjectHolder rhs = PopStack(stack);
+            ObjectHolder lhs = PopStack(stack);
+            stack.push_back(AddValues(lhs, rhs, context));
+            break;
+        }
+        case OpCode::Sub: {
+            ObjectHolder rhs = PopStack(stack);
+            ObjectHolder lhs = PopStack(stack);
+            auto* lhs_n = lhs.TryAs<runtime::Number>();
+            auto* rhs_n = rhs.TryAs<runtime::Number>();
+            if ((nullptr == lhs_n) || (nullptr == rhs_n)) {
+                throw runtime_error(string(__func__) + " is failed");
+            }
+            stack.push_back(ObjectHolder::FromInt(lhs_n->GetValue() - rhs_n->GetValue()));
+            break;
+        }
+        case OpCode::Mul: {
+            ObjectHolder rhs = PopStack(stack);
+            ObjectHolder lhs = PopStack(stack);
+            auto* lhs_n = lhs.TryAs<runtime::Number>();
+            auto* rhs_n = rhs.TryAs<runtime::Number>();
+            if ((nullptr == lhs_n) || (nullptr == rhs_n)) {
+                throw runtime_error(string(__func__) + " is failed");
+            }
+            stack.push_back(ObjectHolder::FromInt(lhs_n->GetValue() * rhs_n->GetValue()));
+            break;
+        }
+        case OpCode::Div: {
+            ObjectHolder rhs = PopStack(stack);
+            ObjectHolder lhs = PopStack(stack);
+            auto* lhs_n = lhs.TryAs<runtime::Number>();
+            auto* rhs_n = rhs.TryAs<runtime::Number>();
+            if ((nullptr == lhs_n) || (nullptr == rhs_n) || (0 == rhs_n->GetValue())) {
+                throw runtime_error(string(__func__) + " is failed");
+            }
+            stack.push_back(ObjectHolder::FromInt(lhs_n->GetValue() / rhs_n->GetValue()));
+            break;
+        }
+        case OpCode::Not: {
+            ObjectHolder value = PopStack(stack);
+            stack.push_back(ObjectHolder::FromBool(!BoolValue(value)));
+            break;
+        }
+        case OpCode::And: {
+            ObjectHolder rhs = PopStack(stack);
+            ObjectHolder lhs = PopStack(stack);
+            bool result = BoolValue(lhs) ? BoolValue(rhs) : false;
+            stack.push_back(ObjectHolder::FromBool(result));
+            break;
+        }
+        case OpCode::Or: {
+            ObjectHolder rhs = PopStack(stack);
+            ObjectHolder lhs = PopStack(stack);
+            bool result = BoolValue(lhs) ? true : BoolValue(rhs);
+            stack.push_back(ObjectHolder::FromBool(result));
+            break;
+        }
+        case OpCode::CmpEq:
+        case OpCode::CmpNotEq:
+        case OpCode::CmpLess:
+        case OpCode::CmpGreater:
+        case OpCode::CmpLessEq:
+        case OpCode::CmpGreaterEq: {
+            ObjectHolder rhs = PopStack(stack);
+            ObjectHolder lhs = PopStack(stack);
+            bool result = false;
+            switch (insn.op) {
+            case OpCode::CmpEq:
+                result = runtime::Equal(lhs, rhs, context);
+                break;
+            case OpCode::CmpNotEq:
+                result = runtime::NotEqual(lhs, rhs, context);
+                break;
+            case OpCode::CmpLess:
+                result = runtime::Less(lhs, rhs, context);
+                break;
+            case OpCode::CmpGreater:
+                result = runtime::Greater(lhs, rhs, context);
+                break;
+            case OpCode::CmpLessEq:
+                result = runtime::LessOrEqual(lhs, rhs, context);
+                break;
+            default:
+                result = runtime::GreaterOrEqual(lhs, rhs, context);
+                break;
+            }
+            stack.push_back(ObjectHolder::FromBool(result));
+            break;
+        }
+        case OpCode::JumpIfFalse: {
+            ObjectHolder condition = PopStack(stack);
+            if (!BoolValue(condition)) {
+                ip = insn.arg;
+            }
+            break;
+        }
+        case OpCode::Jump:
+            ip = insn.arg;
+            break;
+        case OpCode::Print: {
+            // вывод в том же формате, что и ast::Print::Execute
+            ostringstream os;
+            size_t args_count = insn.arg;
+            for (size_t i = 0; i < args_count; ++i) {
+                if (i != 0) {
+                    os << ' ';
+                }
+                const ObjectHolder& oh = stack[stack.size() - args_count + i];
+                if (runtime::Object* obj = oh.Get()) {
+                    obj->Print(os, context);
+                }
+                else {
+                    os << "None"s;
+                }
+            }
+            stack.resize(stack.size() - args_count);
+            // '\n' вместо endl: поток не сбрасывается на каждой печати
+            context.GetOutputStream() << os.str() << '\n';
+            stack.push_back(ObjectHolder::None());
+            break;
+        }
+        case OpCode::Pop:
+            stack.pop_back();
+            break;
+        }
+    }
+
+    if (stack.empty()) {
+        return ObjectHolder::None();
+    }
+    return stack.back();
+}
+
+
+namespace {
+
+// теги типов констант в сериализованном виде
+enum class ConstTag : uint8_t {
+    None = 0,
+    Number = 1,
+    Bool = 2,
+    String = 3,
+};
+
+// magic-число заголовка: "MYBC"
+constexpr uint32_t CHUNK_MAGIC = 0x4342594D;
+
+template <typename T>
+void WriteRaw(ostream& out, T value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof value);
+}
+
+template <typename T>
+bool ReadRaw(istream& in, T& value) {
+    in.read(reinterpret_cast<char*>(&value), sizeof value);
+    return static_cast<bool>(in);
+}
+
+void WriteString(ostream& out, const string& value) {
+    WriteRaw(out, static_cast<uint32_t>(value.size()));
+    out.write(value.data(), static_cast<streamsize>(value.size()));
+}
+
+bool ReadString(istream& in, string& value) {
+    uint32_t size = 0;
+    if (!ReadRaw(in, size)) {
+        return false;
+    }
+    value.resize(size);
+    in.read(value.data(), static_cast<streamsize>(size));
+    return static_cast<bool>(in);
+}
+
+}  // namespace
+
+uint64_t HashSource(string_view source) {
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ULL;
+    for (char ch : source) {
+        hash ^= static_cast<unsigned char>(ch);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+void SaveChunk(const Chunk& chunk, ostream& out, uint64_t source_hash) {
+    WriteRaw(out, CHUNK_MAGIC);
+    WriteRaw(out, CHUNK_FORMAT_VERSION);
+    WriteRaw(out, source_hash);
+    WriteRaw(out, static_cast<uint32_t>(chunk.Code().size()));
+    WriteRaw(out, static_cast<uint32_t>(chunk.Constants().size()));
+    WriteRaw(out, static_cast<uint32_t>(chunk.Names().size()));
+
+    for (const Instruction& instruction : chunk.Code()) {
+        WriteRaw(out, static_cast<uint32_t>(instruction.op));
+        WriteRaw(out, instruction.arg);
+    }
+
+    for (const ObjectHolder& constant : chunk.Constants()) {
+        if (const auto* number = constant.TryAs<runtime::Number>()) {
+            WriteRaw(out, static_cast<uint8_t>(ConstTag::Number));
+            WriteRaw(out, static_cast<int32_t>(number->GetValue()));
+        }
+        else if (const auto* flag = constant.TryAs<runtime::Bool>()) {
+            WriteRaw(out, static_cast<uint8_t>(ConstTag::Bool));
+            WriteRaw(out, static_cast<uint8_t>(flag->GetValue() ? 1 : 0));
+        }
+        else if (const auto* text = constant.TryAs<runtime::String>()) {
+            WriteRaw(out, static_cast<uint8_t>(ConstTag::String));
+            WriteString(out, text->GetValue());
+        }
+        else {
+            WriteRaw(out, static_cast<uint8_t>(ConstTag::None));
+        }
+    }
+
+    for (const string& name : chunk.Names()) {
+        WriteString(out, name);
+    }
+}
+
+optional<Chunk> LoadChunk(istream& in, uint64_t expected_source_hash) {
+    uint32_t magic = 0;
+    uint32_t version = 0;
+    uint64_t source_hash = 0;
+    uint32_t code_count = 0;
+    uint32_t const_count = 0;
+    uint32_t name_count = 0;
+    if (!ReadRaw(in, magic) || (magic != CHUNK_MAGIC) ||
+        !ReadRaw(in, version) || (version != CHUNK_FORMAT_VERSION) ||
+        !ReadRaw(in, source_hash) || (source_hash != expected_source_hash) ||
+        !ReadRaw(in, code_count) || !ReadRaw(in, const_count) || !ReadRaw(in, name_count)) {
+        return nullopt;
+    }
+
+    Chunk chunk;
+    chunk.code_.reserve(code_count);
+    for (uint32_t i = 0; i < code_count; ++i) {
+        uint32_t op = 0;
+        uint32_t arg = 0;
+        if (!ReadRaw(in, op) || !ReadRaw(in, arg) ||
+            (op > static_cast<uint32_t>(OpCode::Pop))) {
+            return nullopt;
+        }
+        chunk.code_.push_back(Instruction{static_cast<OpCode>(op), arg});
+    }
+
+    chunk.constants_.reserve(const_count);
+    for (uint32_t i = 0; i < const_count; ++i) {
+        uint8_t tag = 0;
+        if (!ReadRaw(in, tag)) {
+            return nullopt;
+        }
+        switch (static_cast<ConstTag>(tag)) {
+        case ConstTag::None:
+            chunk.constants_.push_back(ObjectHolder::None());
+            break;
+        case ConstTag::Number: {
+            int32_t value = 0;
+            if (!ReadRaw(in, value)) {
+                return nullopt;
+            }
+            chunk.constants_.push_back(ObjectHolder::FromInt(value));
+            break;
+        }
+        case ConstTag::Bool: {
+            uint8_t value = 0;
+            if (!ReadRaw(in, value)) {
+                return nullopt;
+            }
+            chunk.constants_.push_back(ObjectHolder::FromBool(value != 0));
+            break;
+        }
+        case ConstTag::String: {
+            string value;
+            if (!ReadString(in, value)) {
+                return nullopt;
+            }
+            chunk.constants_.push_back(ObjectHolder::Own(runtime::String(std::move(value))));
+            break;
+        }
+        default:
+            return nullopt;
+        }
+    }
+
+    chunk.names_.reserve(name_count);
+    for (uint32_t i = 0; i < name_count; ++i) {
+        string name;
+        if (!ReadString(in, name)) {
+            return nullopt;
+        }
+        chunk.names_.push_back(std::move(name));
+    }
+
+    return chunk;
+}
+
+}  // namespace vm
@@ -0,0 +1,131 @@
+#pragma once
+
+#include "runtime.h"
+
+#include <cstdint>
+#include <iosfwd>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace vm {
+
+// Коды операций виртуальной машины
+enum class OpCode : uint8_t {
+    Const,        // положить константу constants[arg] на стек
+    LoadNone,     // положить None на стек
+    LoadVar,      // положить значение переменной names[arg] на стек
+    StoreVar,     // записать вершину стека в переменную names[arg]
+    Add,          // сложить два верхних значения стека
+    Sub,          // вычесть два верхних значения стека
+    Mul,          // перемножить два верхних значения стека
+    Div,          // разделить два верхних значения стека
+    Not,          // логическое отрицание вершины стека
+    And,          // логическое И двух верхних значений стека
+    Or,           // логическое ИЛИ двух верхних значений стека
+    CmpEq,        // сравнение == двух верхних значений стека
+    CmpNotEq,     // сравнение !=
+    CmpLess,      // сравнение <
+    CmpGreater,   // сравнение >
+    CmpLessEq,    // сравнение <=
+    CmpGreaterEq, // сравнение >=
+    JumpIfFalse,  // снять вершину стека и перейти на arg, если она ложна
+    Jump,         // безусловный переход на arg
+    Print,        // снять arg значений со стека и напечатать их
+    Pop,          // снять вершину стека
+};
+
+// Инструкция: код операции и её аргумент
+struct Instruction {
+    OpCode op;
+    uint32_t arg = 0;
+};
+
+class Chunk;
+
+// Версия формата сериализации байт-кода (см. SaveChunk/LoadChunk)
+constexpr uint32_t CHUNK_FORMAT_VERSION = 1;
+
+// Возвращает FNV-1a хеш исходного текста программы -
+// ключ кеша сериализованного байт-кода
+uint64_t HashSource(std::string_view source);
+
+/*
+ * Записывает chunk в поток out вместе с версией формата и хешем исходного
+ * текста source_hash. Раскладка плоская: заголовок фиксированной ширины,
+ * затем массив инструкций, пул констант и пул имён - при загрузке файл
+ * читается последовательно, без обратных ссылок
+ */
+void SaveChunk(const Chunk& chunk, std::ostream& out, uint64_t source_hash);
+
+/*
+ * Читает chunk из потока in. Возвращает std::nullopt, если данные
+ * повреждены, версия формата не совпадает или сохранённый хеш исходного
+ * текста отличается от expected_source_hash - устаревший кеш
+ * отбрасывается, и программу нужно компилировать заново
+ */
+std::optional<Chunk> LoadChunk(std::istream& in, uint64_t expected_source_hash);
+
+// Скомпилированная программа: плоский массив инструкций,
+// пул констант и таблица имён переменных
+class Chunk {
+    friend class Compiler;
+    friend std::optional<Chunk> LoadChunk(std::istream& in, uint64_t expected_source_hash);
+
+public:
+    [[nodiscard]] const std::vector<Instruction>& Code() const {
+        return code_;
+    }
+
+    [[nodiscard]] const std::vector<runtime::ObjectHolder>& Constants() const {
+        return constants_;
+    }
+
+    [[nodiscard]] const std::vector<std::string>& Names() const {
+        return names_;
+    }
+
+private:
+    std::vector<Instruction> code_;
+    std::vector<runtime::ObjectHolder> constants_;
+    std::vector<std::string> names_;
+};
+
+// Компилятор, понижающий дерево ast::Statement в байт-код.
+// Узлы AST записывают свои инструкции через методы Emit*/Add*
+class Compiler {
+public:
+    // Компилирует программу program в байт-код.
+    // Возвращает std::nullopt, если программа содержит узлы,
+    // не поддерживаемые компилятором - тогда вызывающая сторона
+    // должна выполнять дерево через Execute
+    static std::optional<Chunk> Compile(const runtime::Executable& program);
+
+    // Добавляет инструкцию в конец байт-кода
+    void Emit(OpCode op, uint32_t arg = 0);
+    // Возвращает позицию следующей инструкции - цель обратного перехода
+    [[nodiscard]] size_t Position() const;
+    // Добавляет инструкцию перехода и возвращает её позицию для PatchJump
+    size_t EmitJump(OpCode op);
+    // Настраивает переход в позиции jump_pos на текущий конец байт-кода
+    void PatchJump(size_t jump_pos);
+
+    // Помещает константу в пул и возвращает её индекс
+    uint32_t AddConstant(runtime::ObjectHolder value);
+    // Помещает имя переменной в таблицу имён и возвращает его индекс
+    uint32_t AddName(const std::string& name);
+
+    // Компилирует вложенный узел node. Возвращает false, если узел не поддерживается
+    bool CompileNode(const runtime::Executable& node);
+
+private:
+    Chunk chunk_;
+};
+
+// Выполняет байт-код chunk над таблицей символов closure в контексте context.
+// Возвращает значение вершины стека либо None
+runtime::ObjectHolder Run(const Chunk& chunk, runtime::Closure& closure,
+                          runtime::Context& context);
+
+}  // namespace vm
@@ -0,0 +1,170 @@
+#include "vm.h"
+
+#include "lexer.h"
+#include "parse.h"
+#include "statement.h"
+#include "test_runner.h"
+
+#include <sstream>
+
+using namespace std;
+
+namespace vm {
+
+namespace {
+
+// компилирует программу в байт-код и выполняет её на виртуальной машине
+void RunProgramOnVm(istream& input, ostream& output) {
+    parse::Lexer lexer(input);
+    auto program = ParseProgram(lexer);
+
+    optional<Chunk> chunk = Compiler::Compile(*program);
+    ASSERT(chunk.has_value());
+
+    runtime::SimpleContext context{output};
+    runtime::Closure closure;
+    Run(*chunk, closure, context);
+}
+
+void TestSimplePrints() {
+    istringstream input(R"(
+print 57
+print 10, 24, -8
+print 'hello'
+print True, False
+print
+print None
+)");
+
+    ostringstream output;
+    RunProgramOnVm(input, output);
+
+    ASSERT_EQUAL(output.str(), "57\n10 24 -8\nhello\nTrue False\n\nNone\n");
+}
+
+void TestArithmetics() {
+    istringstream input("print 1+2+3+4+5, 1*2*3*4*5, 1-2-3-4-5, 36/4/3, 2*5+10/2");
+
+    ostringstream output;
+    RunProgramOnVm(input, output);
+
+    ASSERT_EQUAL(output.str(), "15 120 -13 3 15\n");
+}
+
+void TestAssignmentsAndConditions() {
+    istringstream input(R"(
+x = 4
+y = 5
+if x < y:
+  smallest = x
+else:
+  smallest = y
+print smallest, x + y, not x > y
+)");
+
+    ostringstream output;
+    RunProgramOnVm(input, output);
+
+    ASSERT_EQUAL(output.str(), "4 9 True\n");
+}
+
+void TestStrings() {
+    istringstream input(R"(
+greeting = 'hello, ' + 'world'
+print greeting, greeting == 'hello, world'
+)");
+
+    ostringstream output;
+    RunProgramOnVm(input, output);
+
+    ASSERT_EQUAL(output.str(), "hello, world True\n");
+}
+
+void TestFallbackForUnsupportedNodes() {
+    // классы и вызовы методов байт-кодом пока не поддерживаются -
+    // компилятор должен отказаться, а не выдать неверный код
+    istringstream input(R"(
+class Counter:
+  def __init__():
+    self.value = 0
+
+x = Counter()
+)");
+
+    parse::Lexer lexer(input);
+    auto program = ParseProgram(lexer);
+
+    ASSERT(!Compiler::Compile(*program).has_value());
+}
+
+void TestWhileLoop() {
+    istringstream input(R"(
+i = 0
+total = 0
+while i < 10:
+  i = i + 1
+  total = total + i
+print total
+)"s);
+
+    parse::Lexer lexer(input);
+    auto tree = ParseProgram(lexer);
+
+    // цикл компилируется в байт-код с обратным переходом
+    auto chunk = Compiler::Compile(*tree);
+    ASSERT(chunk.has_value());
+
+    runtime::DummyContext context;
+    runtime::Closure closure;
+    Run(*chunk, closure, context);
+    ASSERT_EQUAL(context.output.str(), "55\n"s);
+}
+
+void TestSaveAndLoadChunk() {
+    const string source = R"(
+x = 2
+y = x + 3
+print y, 'ok', True
+)"s;
+
+    istringstream input(source);
+    parse::Lexer lexer(input);
+    auto tree = ParseProgram(lexer);
+    auto chunk = Compiler::Compile(*tree);
+    ASSERT(chunk.has_value());
+
+    uint64_t hash = HashSource(source);
+    stringstream cache;
+    SaveChunk(*chunk, cache, hash);
+
+    // кеш с совпадающим хешем исходника загружается и выполняется
+    auto loaded = LoadChunk(cache, hash);
+    ASSERT(loaded.has_value());
+    runtime::DummyContext context;
+    runtime::Closure closure;
+    Run(*loaded, closure, context);
+    ASSERT_EQUAL(context.output.str(), "5 ok True\n"s);
+
+    // хеш другого исходника - кеш устарел и отбрасывается
+    cache.clear();
+    cache.seekg(0);
+    ASSERT(!LoadChunk(cache, hash + 1).has_value());
+
+    // повреждённый заголовок тоже отбрасывается
+    stringstream broken("not a chunk"s);
+    ASSERT(!LoadChunk(broken, hash).has_value());
+}
+
+}  // namespace
+
+void RunVmTests(TestRunner& tr) {
+    RUN_TEST(tr, vm::TestSimplePrints);
+    RUN_TEST(tr, vm::TestArithmetics);
+    RUN_TEST(tr, vm::TestAssignmentsAndConditions);
+    RUN_TEST(tr, vm::TestStrings);
+    RUN_TEST(tr, vm::TestFallbackForUnsupportedNodes);
+    RUN_TEST(tr, vm::TestWhileLoop);
+    RUN_TEST(tr, vm::TestSaveAndLoadChunk);
+}
+
+}  // namespace vm